@@ -259,9 +259,6 @@ static uint64_t get_random_binary64_mask(void) {
     const typeof(B.u) mask_one = GET_MASK_ONE(B.type);                         \
     const int binary_t = GET_BINARYN_T(B.type);                                \
     typeof(B.u) bitmask = GET_BITMASK(B.type);                                 \
-    _init_rng_state_struct(&rng_state, ((t_context *)CTX)->choose_seed,        \
-                           (unsigned long long)(((t_context *)CTX)->seed),     \
-                           false);                                             \
     if (FPCLASSIFY(*x) == FP_SUBNORMAL) {                                      \
       /* We must use the CLZ2 variant since bitfield type                      \
            are incompatible with _Generic feature */                           \
@@ -286,7 +283,8 @@ static uint64_t get_random_binary64_mask(void) {
     *x = B.type;                                                               \
   } while (0);
 
-static void _inexact_binary32(void *context, float *x) {
+static void _inexact_binary32(__attribute__((unused)) void *context,
+                               float *x) {
   if (_MUST_NOT_BE_NOISED(*x, BITMASKLIB_BINARY32_T)) {
     return;
   } else {
@@ -295,7 +293,8 @@ static void _inexact_binary32(void *context, float *x) {
   }
 }
 
-static void _inexact_binary64(void *context, double *x) {
+static void _inexact_binary64(__attribute__((unused)) void *context,
+                               double *x) {
   if (_MUST_NOT_BE_NOISED(*x, BITMASKLIB_BINARY64_T)) {
     return;
   } else {
@@ -368,6 +367,167 @@ _INTERFLOP_OP_CALL(double, mul, bitmask_mul, _bitmask_binary64_binary_op);
 
 _INTERFLOP_OP_CALL(double, div, bitmask_div, _bitmask_binary64_binary_op);
 
+/******************** BITMASK USER CALLS ********************
+ * INTERFLOP_INEXACT_ARRAY_ID applies the bitmask operator to whole
+ * arrays: the random masks are drawn BITMASK_INEXACT_ARRAY_CHUNK at a
+ * time and the normal values are masked in a branch-free loop that the
+ * compiler vectorizes. The mask of a subnormal value depends on its
+ * leading zeros, it is computed as in _INEXACT after the loop.
+ *******************************************************************/
+
+/* Number of elements masked with each buffer of random masks */
+#define BITMASK_INEXACT_ARRAY_CHUNK 256
+
+/* Applies the operator OPERATOR with bitmask MASK to the bits U */
+#define _BITMASK_APPLY(OPERATOR, U, MASK, RAND_MASK)                           \
+  (((OPERATOR) == bitmask_operator_rand)  ? (U) ^ (~(MASK) & (RAND_MASK))      \
+   : ((OPERATOR) == bitmask_operator_one) ? (U) | ~(MASK)                      \
+                                          : (U) & (MASK))
+
+/* Applies the operator with bitmask BITMASK to the M normal values of X */
+/* and flags the subnormal ones in SUBNORMAL, B is a binary32 or binary64 */
+/* variable used for the conversions. The fields are read with shifts */
+/* since bitfields are not vectorized */
+#define _INEXACT_ARRAY_KERNEL(X, RAND, SUBNORMAL, M, BITMASK, OPERATOR, B)     \
+  {                                                                            \
+    const typeof(B.u) pman_size = GET_PMAN_SIZE(B.type);                       \
+    const typeof(B.u) exp_inf = ((typeof(B.u))1 << GET_EXP_SIZE(B.type)) - 1;  \
+    for (size_t j = 0; j < M; j++) {                                           \
+      B.type = X[j];                                                           \
+      const typeof(B.u) u = B.u;                                               \
+      const typeof(B.u) exp = (u >> pman_size) & exp_inf;                      \
+      const typeof(B.u) man = u & ((((typeof(B.u))1) << pman_size) - 1);       \
+      const typeof(B.u) normal =                                               \
+          -(typeof(B.u))((exp != 0) & (exp != exp_inf));                       \
+      SUBNORMAL[j] = (exp == 0) & (man != 0);                                  \
+      B.u = (_BITMASK_APPLY(OPERATOR, u, BITMASK, (typeof(B.u))RAND[j]) &      \
+             normal) |                                                         \
+            (u & ~normal);                                                     \
+      X[j] = B.type;                                                           \
+    }                                                                          \
+  }
+
+TARGET_CLONES static void _inexact_array_kernel_binary32(
+    float *restrict x, const uint64_t *restrict rand, bool *restrict subnormal,
+    const size_t m, const uint32_t bitmask, const bitmask_operator op) {
+  binary32 b32;
+  _INEXACT_ARRAY_KERNEL(x, rand, subnormal, m, bitmask, op, b32);
+}
+
+TARGET_CLONES static void _inexact_array_kernel_binary64(
+    double *restrict x, const uint64_t *restrict rand, bool *restrict subnormal,
+    const size_t m, const uint64_t bitmask, const bitmask_operator op) {
+  binary64 b64;
+  _INEXACT_ARRAY_KERNEL(x, rand, subnormal, m, bitmask, op, b64);
+}
+
+/* Applies the bitmask operator of virtual precision T to the N values of */
+/* X with KERNEL, B is a binary32 or binary64 variable */
+#define _INEXACT_ARRAY(X, N, T, KERNEL, B)                                     \
+  {                                                                            \
+    const bitmask_operator op = BITMASKLIB_OPERATOR;                           \
+    const typeof(B.u) lead_size =                                              \
+        GET_SIGN_SIZE(B.type) + GET_EXP_SIZE(B.type);                          \
+    const typeof(B.u) pman_size = GET_PMAN_SIZE(B.type);                       \
+    const typeof(B.u) mask_one = GET_MASK_ONE(B.type);                         \
+    const typeof(B.u) bitmask = mask_one << (GET_PREC(B.type) - T);            \
+    uint64_t rand[BITMASK_INEXACT_ARRAY_CHUNK] = {0};                          \
+    bool subnormal[BITMASK_INEXACT_ARRAY_CHUNK];                               \
+    for (size_t i = 0; i < N; i += BITMASK_INEXACT_ARRAY_CHUNK) {              \
+      const size_t m = (N - i < BITMASK_INEXACT_ARRAY_CHUNK)                   \
+                           ? N - i                                             \
+                           : BITMASK_INEXACT_ARRAY_CHUNK;                      \
+      if (op == bitmask_operator_rand) {                                       \
+        vfc_rng_fill_uint64(&rng_state, rand, m, &global_tid);                 \
+      }                                                                        \
+      KERNEL(X + i, rand, subnormal, m, bitmask, op);                          \
+      for (size_t j = 0; j < m; j++) {                                         \
+        if (subnormal[j]) {                                                    \
+          B.type = X[i + j];                                                   \
+          const typeof(B.u) leading_0 =                                        \
+              CLZ2(B.u, B.ieee.mantissa) - lead_size;                          \
+          const typeof(B.u) sub_bitmask =                                      \
+              (pman_size < (leading_0 + T))                                    \
+                  ? mask_one                                                   \
+                  : bitmask | (mask_one << (pman_size - (leading_0 + T)));     \
+          B.u = _BITMASK_APPLY(op, B.u, sub_bitmask,                           \
+                               (typeof(B.u))rand[j]);                          \
+          X[i + j] = B.type;                                                   \
+        }                                                                      \
+      }                                                                        \
+    }                                                                          \
+  }
+
+static void _inexact_array_binary32(float *x, const size_t n, const int t) {
+  binary32 b32;
+  _INEXACT_ARRAY(x, n, t, _inexact_array_kernel_binary32, b32);
+}
+
+static void _inexact_array_binary64(double *x, const size_t n, const int t) {
+  binary64 b64;
+  _INEXACT_ARRAY(x, n, t, _inexact_array_kernel_binary64, b64);
+}
+
+static void _interflop_usercall_inexact_array(__attribute__((unused))
+                                              void *context,
+                                              va_list ap) {
+  const enum FTYPES ftype = va_arg(ap, enum FTYPES);
+  void *value = va_arg(ap, void *);
+  const size_t n = va_arg(ap, size_t);
+  const int precision = va_arg(ap, int);
+  int t = 0;
+
+  if (BITMASKLIB_MODE == bitmask_mode_ieee) {
+    return;
+  }
+
+  switch (ftype) {
+  case FFLOAT:
+    t = (precision <= 0) ? (BITMASKLIB_BINARY32_T + precision) : precision;
+    break;
+  case FDOUBLE:
+    t = (precision <= 0) ? (BITMASKLIB_BINARY64_T + precision) : precision;
+    break;
+  default:
+    logger_warning(
+        "Unknown type passed to _interflop_usercall_inexact_array function");
+    return;
+  }
+
+  if (t < BITMASK_PRECISION_BINARY64_MIN) {
+    logger_error("invalid precision (%d) passed to "
+                 "_interflop_usercall_inexact_array function",
+                 t);
+  }
+
+  /* the values are representable on t bits */
+  if (ftype == FFLOAT && t < FLOAT_PREC) {
+    _inexact_array_binary32((float *)value, n, t);
+  } else if (ftype == FDOUBLE && t < DOUBLE_PREC) {
+    _inexact_array_binary64((double *)value, n, t);
+  }
+}
+
+static void _interflop_user_call(void *context, interflop_call_id id,
+                                 va_list ap) {
+  switch (id) {
+  case INTERFLOP_INEXACT_ARRAY_ID:
+    _interflop_usercall_inexact_array(context, ap);
+    break;
+  case INTERFLOP_INEXACT_ID:
+  case INTERFLOP_SET_PRECISION_BINARY32:
+  case INTERFLOP_SET_PRECISION_BINARY64:
+  case INTERFLOP_SET_RANGE_BINARY32:
+  case INTERFLOP_SET_RANGE_BINARY64:
+    /* not supported by BITMASK, ignored as before the backend had a user
+     * call hook */
+    break;
+  default:
+    logger_warning("Unknown interflop_call id (=%d)", id);
+    break;
+  }
+}
+
 static struct argp_option options[] = {
     {key_prec_b32_str, KEY_PREC_B32, "PRECISION", 0,
      "select precision for binary32 (PRECISION > 0)", 0},
@@ -532,13 +692,21 @@ struct interflop_backend_interface_t interflop_init(int argc, char **argv,
       NULL,
       NULL,
       NULL,
+      _interflop_user_call,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
       NULL,
       NULL};
 
   /* The seed for the RNG is initialized upon the first request for a random
      number */
 
-  _init_rng_state_struct(&rng_state, ctx->choose_seed, ctx->seed, false);
+  vfc_rng_set_seed(ctx->choose_seed, ctx->seed);
 
   return interflop_backend_bitmask;
 }
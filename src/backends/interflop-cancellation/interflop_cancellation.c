@@ -95,9 +95,6 @@ static inline double _noise_binary64(const int exp, rng_state_t *rng_state) {
        * This particular version in the case of cancellations does not use     \
        * extended quad types */                                                \
       const int32_t e_n = e_z - (cancellation - 1);                            \
-      _init_rng_state_struct(&RNG_STATE, ((t_context *)CTX)->choose_seed,      \
-                             (unsigned long long)(((t_context *)CTX)->seed),   \
-                             false);                                           \
       *Z += _noise_binary64(e_n, &RNG_STATE);                                  \
     }                                                                          \
   })
@@ -220,13 +217,20 @@ struct interflop_backend_interface_t interflop_init(int argc, char **argv,
       NULL,
       NULL,
       NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
       NULL};
 
   /* The seed for the RNG is initialized upon the first request for a random
      number */
 
-  _init_rng_state_struct(&rng_state, ctx->choose_seed,
-                         (unsigned long long int)(ctx->seed), false);
+  vfc_rng_set_seed(ctx->choose_seed, ctx->seed);
 
   return interflop_backend_cancellation;
 }
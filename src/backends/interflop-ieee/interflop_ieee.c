@@ -422,7 +422,15 @@ struct interflop_backend_interface_t interflop_init(int argc, char **argv,
       NULL,
       NULL,
       NULL,
-      _interflop_finalize};
+      _interflop_finalize,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL};
 
   return interflop_backend_ieee;
 }
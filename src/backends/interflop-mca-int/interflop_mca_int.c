@@ -28,6 +28,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
@@ -39,6 +40,7 @@
 #include "../../common/float_utils.h"
 #include "../../common/interflop.h"
 #include "../../common/logger.h"
+#include "../../common/mca_simd.h"
 #include "../../common/options.h"
 #include "../../common/rng/vfc_rng.h"
 
@@ -51,7 +53,9 @@ typedef enum {
   KEY_SEED = 's',
   KEY_DAZ = 'd',
   KEY_FTZ = 'f',
-  KEY_SPARSITY = 'n'
+  KEY_SPARSITY = 'n',
+  KEY_SIMD,
+  KEY_QUAD_BINARY64
 } key_args;
 
 static const char key_prec_b32_str[] = "precision-binary32";
@@ -63,6 +67,8 @@ static const char key_seed_str[] = "seed";
 static const char key_daz_str[] = "daz";
 static const char key_ftz_str[] = "ftz";
 static const char key_sparsity_str[] = "sparsity";
+static const char key_simd_str[] = "simd";
+static const char key_quad_binary64_str[] = "quad-binary64";
 
 typedef struct {
   bool relErr;
@@ -73,6 +79,13 @@ typedef struct {
   bool daz;
   bool ftz;
   float sparsity;
+  int simd;
+  bool quad_binary64;
+  /* virtual precisions and mode copied by the threads */
+  int mode;
+  int binary32_t;
+  int binary64_t;
+  unsigned int generation;
 } t_context;
 
 /* define the available MCA modes of operation */
@@ -104,9 +117,12 @@ static const char *MCA_ERR_MODE_STR[] = {"rel", "abs", "all"};
 #define MCA_PRECISION_BINARY64_DEFAULT 53
 #define MCA_MODE_DEFAULT mcamode_mca
 
-static mcamode MCALIB_MODE = MCA_MODE_DEFAULT;
-static int MCALIB_BINARY32_T = MCA_PRECISION_BINARY32_DEFAULT;
-static int MCALIB_BINARY64_T = MCA_PRECISION_BINARY64_DEFAULT;
+/* thread-local copies of the mode and virtual precisions of the context */
+static __thread mcamode MCALIB_MODE = MCA_MODE_DEFAULT;
+static __thread int MCALIB_BINARY32_T = MCA_PRECISION_BINARY32_DEFAULT;
+static __thread int MCALIB_BINARY64_T = MCA_PRECISION_BINARY64_DEFAULT;
+/* generation of the context copied, 0 until the first copy */
+static __thread unsigned int MCALIB_GENERATION = 0;
 
 /* possible operations values */
 typedef enum {
@@ -124,26 +140,45 @@ static double _mca_binary64_binary_op(double a, double b,
 /******************** MCA CONTROL FUNCTIONS *******************
  * The following functions are used to set virtual precision and
  * MCA mode of operation.
+ * The operations read thread-local copies of the ones of the context,
+ * made by each thread on its first operation.
  ***************************************************************/
 
-/* Set the mca mode */
-static void _set_mca_mode(const mcamode mode) {
+/* Set the mca mode of the context */
+static void _set_mca_mode(t_context *ctx, const mcamode mode) {
   if (mode >= _mcamode_end_) {
     logger_error("--%s invalid value provided, must be one of: "
                  "{ieee, mca, pb, rr}.",
                  key_mode_str);
   }
-  MCALIB_MODE = mode;
+  ctx->mode = mode;
 }
 
-/* Set the virtual precision for binary32 */
-static void _set_mca_precision_binary32(const int precision) {
-  _set_precision(MCA, precision, &MCALIB_BINARY32_T, (float)0);
+/* Set the virtual precision for binary32 of the context */
+static void _set_mca_precision_binary32(t_context *ctx, const int precision) {
+  _set_precision(MCA, precision, &ctx->binary32_t, (float)0);
 }
 
-/* Set the virtual precision for binary64 */
-static void _set_mca_precision_binary64(const int precision) {
-  _set_precision(MCA, precision, &MCALIB_BINARY64_T, (double)0);
+/* Set the virtual precision for binary64 of the context */
+static void _set_mca_precision_binary64(t_context *ctx, const int precision) {
+  _set_precision(MCA, precision, &ctx->binary64_t, (double)0);
+}
+
+/* Copies the mode and virtual precisions of the context in the thread */
+static void _mca_load_state(const t_context *ctx) {
+  MCALIB_GENERATION = __atomic_load_n(&ctx->generation, __ATOMIC_ACQUIRE);
+  MCALIB_MODE = __atomic_load_n(&ctx->mode, __ATOMIC_RELAXED);
+  MCALIB_BINARY32_T = __atomic_load_n(&ctx->binary32_t, __ATOMIC_RELAXED);
+  MCALIB_BINARY64_T = __atomic_load_n(&ctx->binary64_t, __ATOMIC_RELAXED);
+}
+
+/* Updates the thread-local state if the one of the context has changed */
+static inline void _mca_sync_state(const t_context *ctx) {
+  const unsigned int generation =
+      __atomic_load_n(&ctx->generation, __ATOMIC_RELAXED);
+  if (generation != MCALIB_GENERATION) {
+    _mca_load_state(ctx);
+  }
 }
 
 /******************** MCA RANDOM FUNCTIONS ********************
@@ -232,8 +267,6 @@ static void _noise_binary128(__float128 *x, const int exp,
 #define _INEXACT(X, VIRTUAL_PRECISION, CTX, RNG_STATE)                         \
   {                                                                            \
     t_context *TMP_CTX = (t_context *)CTX;                                     \
-    _init_rng_state_struct(&RNG_STATE, TMP_CTX->choose_seed,                   \
-                           (unsigned long long)(TMP_CTX->seed), false);        \
     if (_MUST_NOT_BE_NOISED(*X, VIRTUAL_PRECISION)) {                          \
       return;                                                                  \
     } else if (_mca_skip_eval(TMP_CTX->sparsity, &(RNG_STATE), &global_tid)) { \
@@ -261,6 +294,222 @@ static void _mca_inexact_binary128(__float128 *qa, void *context) {
            : _mca_inexact_binary64, __float128                                 \
            : _mca_inexact_binary128)(A, CTX)
 
+/******************** MCA INTEGER BINARY64 ARITHMETIC ********************
+ * binary64 operations are computed on binary128 values unpacked into
+ * integers: a sign, an exponent and the 113-bit significand held in an
+ * unsigned __int128. Products are computed on 64-bit limbs and quotients
+ * with the division of 3 limbs by 2 limbs. Each result is rounded to
+ * nearest even on 113 bits and the noise is added to its binary128 bits,
+ * so the results are the ones of a computation in __float128, without
+ * the software binary128 routines.
+ *************************************************************************/
+
+/* binary128 value (-1)^sign * mant * 2^exp, mant is 0 for a zero and */
+/* lies in [2^112, 2^113) otherwise */
+typedef struct {
+  bool sign;
+  int32_t exp;
+  __uint128_t mant;
+} mca_quad_t;
+
+/* Hidden bit of the binary128 significand */
+#define MCA_QUAD_HIDDEN ((__uint128_t)1 << QUAD_PMAN_SIZE)
+
+/* Returns the number of leading 0-bits of the non-zero x */
+static inline int _clz128(const __uint128_t x) {
+  const uint64_t high = x >> 64;
+  return (high != 0) ? __builtin_clzll(high)
+                     : 64 + __builtin_clzll((uint64_t)x);
+}
+
+/* Returns the number of trailing 0-bits of the non-zero x */
+static inline int _ctz128(const __uint128_t x) {
+  const uint64_t low = x;
+  return (low != 0) ? __builtin_ctzll(low)
+                    : 64 + __builtin_ctzll((uint64_t)(x >> 64));
+}
+
+/* Unpacks the finite non-zero binary64 x */
+static inline mca_quad_t _mca_quad_unpack(const double x) {
+  const binary64 b64 = {.f64 = x};
+  uint64_t mant = b64.u64 & DOUBLE_GET_PMAN;
+  int32_t exp = (b64.u64 & DOUBLE_GET_EXP) >> DOUBLE_PMAN_SIZE;
+  if (exp == 0) {
+    /* subnormals are normalized */
+    const int lz = __builtin_clzll(mant) - DOUBLE_EXP_SIZE;
+    mant <<= lz;
+    exp = 1 - lz;
+  } else {
+    mant |= 1ULL << DOUBLE_PMAN_SIZE;
+  }
+  const mca_quad_t q = {
+      .sign = (b64.u64 & DOUBLE_GET_SIGN) != 0,
+      .exp = exp - DOUBLE_EXP_COMP - QUAD_PMAN_SIZE,
+      .mant = (__uint128_t)mant << (QUAD_PMAN_SIZE - DOUBLE_PMAN_SIZE)};
+  return q;
+}
+
+/* Rounds (-1)^sign * x * 2^exp to nearest even on 113 bits, sticky */
+/* tells if non-zero bits below x were dropped; x is non-zero */
+static inline mca_quad_t _mca_quad_round(const bool sign, __uint128_t x,
+                                         int32_t exp, const bool sticky) {
+  const int shift = (127 - _clz128(x)) - QUAD_PMAN_SIZE;
+  if (shift <= 0) {
+    const mca_quad_t q = {
+        .sign = sign, .exp = exp + shift, .mant = x << -shift};
+    return q;
+  }
+  /* the remainder is rounded up when it exceeds half, or equals half */
+  /* with dropped bits below it or an odd x */
+  const __uint128_t rem = x & (((__uint128_t)1 << shift) - 1);
+  const __uint128_t half = (__uint128_t)1 << (shift - 1);
+  x >>= shift;
+  exp += shift;
+  x += (rem + (half - 1) + (sticky | (bool)(x & 1))) >> shift;
+  if (x == 2 * MCA_QUAD_HIDDEN) {
+    x = MCA_QUAD_HIDDEN;
+    exp++;
+  }
+  const mca_quad_t q = {.sign = sign, .exp = exp, .mant = x};
+  return q;
+}
+
+/* Returns x + y rounded to binary128, x and y are non-zero */
+static inline mca_quad_t _mca_quad_add(mca_quad_t x, mca_quad_t y) {
+  /* x holds the operand of larger magnitude */
+  if (y.exp > x.exp || (y.exp == x.exp && y.mant > x.mant)) {
+    const mca_quad_t tmp = x;
+    x = y;
+    y = tmp;
+  }
+  /* 14 guard bits, the bits of y shifted out are jammed into its last */
+  /* bit, which keeps the rounding of the exact sum */
+  const uint32_t d = x.exp - y.exp;
+  const __uint128_t mx = x.mant << 14;
+  __uint128_t my = y.mant << 14;
+  if (d >= 128) {
+    my = 1;
+  } else if (d > 0) {
+    my = (my >> d) | ((my & (((__uint128_t)1 << d) - 1)) != 0);
+  }
+  if (x.sign == y.sign) {
+    return _mca_quad_round(x.sign, mx + my, x.exp - 14, false);
+  } else if (mx == my) {
+    /* exact cancellation returns +0 in round to nearest */
+    const mca_quad_t zero = {.sign = false, .exp = 0, .mant = 0};
+    return zero;
+  } else {
+    return _mca_quad_round(x.sign, mx - my, x.exp - 14, false);
+  }
+}
+
+/* Returns x * y rounded to binary128, x and y are non-zero */
+static inline mca_quad_t _mca_quad_mul(const mca_quad_t x,
+                                       const mca_quad_t y) {
+  const uint64_t xl = x.mant, xh = x.mant >> 64;
+  const uint64_t yl = y.mant, yh = y.mant >> 64;
+  /* 256-bit product high:low, the high limbs are below 2^49 */
+  const __uint128_t ll = (__uint128_t)xl * yl;
+  const __uint128_t mid = (__uint128_t)xl * yh + (__uint128_t)xh * yl;
+  const __uint128_t low = ll + (mid << 64);
+  const __uint128_t high =
+      (__uint128_t)xh * yh + (mid >> 64) + (low < ll);
+  /* the product lies in [2^224, 2^226), its 126 leading bits are kept */
+  const __uint128_t r = (high << 28) | (low >> 100);
+  return _mca_quad_round(x.sign ^ y.sign, r, x.exp + y.exp + 100,
+                         (low << 28) != 0);
+}
+
+/* Divides u2:u1:u0 by the normalized 2-limb d, with u2:u1 < d */
+/* Returns the quotient limb and sets r to the remainder */
+static inline uint64_t _mca_udiv_3by2(const uint64_t u2, const uint64_t u1,
+                                      const uint64_t u0, const __uint128_t d,
+                                      __uint128_t *r) {
+  const uint64_t d1 = d >> 64, d0 = d;
+  const __uint128_t u = ((__uint128_t)u2 << 64) | u1;
+  /* the estimate from the leading limbs exceeds the quotient by at most 2 */
+  uint64_t q = (u2 >= d1) ? UINT64_MAX : (uint64_t)(u / d1);
+  __uint128_t rhat = u - (__uint128_t)q * d1;
+  while ((rhat >> 64) == 0 && (__uint128_t)q * d0 > ((rhat << 64) | u0)) {
+    q--;
+    rhat += d1;
+  }
+  *r = (((__uint128_t)u1 << 64) | u0) - (__uint128_t)q * d;
+  return q;
+}
+
+/* Returns x / y rounded to binary128, x and y are non-zero */
+static inline mca_quad_t _mca_quad_div(const mca_quad_t x,
+                                       const mca_quad_t y) {
+  /* (x.mant * 2^142) / (y.mant * 2^15) lies in (2^126, 2^128) */
+  const __uint128_t d = y.mant << 15;
+  const __uint128_t n = x.mant << 14;
+  __uint128_t r;
+  const uint64_t q1 = _mca_udiv_3by2(n >> 64, n, 0, d, &r);
+  const uint64_t q0 = _mca_udiv_3by2(r >> 64, r, 0, d, &r);
+  const __uint128_t q = ((__uint128_t)q1 << 64) | q0;
+  return _mca_quad_round(x.sign ^ y.sign, q, x.exp - y.exp - 127, r != 0);
+}
+
+/* Rounds the non-zero x to the nearest even binary64 */
+static inline double _mca_quad_to_binary64(const mca_quad_t x) {
+  const int32_t exp = x.exp + QUAD_PMAN_SIZE;
+  const bool subnormal = exp < -DOUBLE_EXP_MIN;
+  /* number of bits of the significand below the binary64 ulp */
+  const int32_t shift = (subnormal)
+                            ? -(DOUBLE_EXP_MIN + DOUBLE_PMAN_SIZE) - x.exp
+                            : QUAD_PMAN_SIZE - DOUBLE_PMAN_SIZE;
+  uint64_t mant = 0;
+  if (shift < 128) {
+    const __uint128_t rem = x.mant & (((__uint128_t)1 << shift) - 1);
+    const __uint128_t half = (__uint128_t)1 << (shift - 1);
+    mant = x.mant >> shift;
+    mant += (rem + (half - 1) + (mant & 1)) >> shift;
+  }
+  /* the hidden bit, or a carry of the rounding, increments the exponent */
+  binary64 b64 = {
+      .u64 = (subnormal) ? mant
+                         : ((uint64_t)(exp + DOUBLE_EXP_COMP - 1)
+                            << DOUBLE_PMAN_SIZE) +
+                               mant};
+  if (b64.u64 > DOUBLE_PLUS_INF) {
+    b64.u64 = DOUBLE_PLUS_INF;
+  }
+  b64.u64 |= (x.sign) ? DOUBLE_GET_SIGN : 0;
+  return b64.f64;
+}
+
+/* Adds the noise of _noise_binary128 with exponent exp to the bits of */
+/* the non-zero x, the significand crosses at most one binade */
+static inline void _mca_quad_noise(mca_quad_t *x, const int exp,
+                                   rng_state_t *rng_state) {
+  const uint32_t shift = 1 + QUAD_EXP_SIZE - exp;
+  binary128 noise = {.words64.high = get_rand_uint64(rng_state, &global_tid)};
+  noise.i128 >>= shift;
+  x->mant += noise.i128;
+  if (x->mant < MCA_QUAD_HIDDEN) {
+    /* the lower binade has twice smaller ulps */
+    x->mant += MCA_QUAD_HIDDEN;
+    x->exp--;
+  } else if (x->mant >= 2 * MCA_QUAD_HIDDEN) {
+    x->mant -= MCA_QUAD_HIDDEN;
+    x->exp++;
+  }
+}
+
+/* Adds the mca noise of virtual precision t to the non-zero x in mode, */
+/* as _mca_inexact_binary128 */
+static inline void _mca_inexact_quad(mca_quad_t *x, const int t,
+                                     const mcamode mode, const t_context *ctx,
+                                     rng_state_t *rng_state) {
+  if (mode == mcamode_rr && _ctz128(x->mant) + t > QUAD_PMAN_SIZE) {
+    return;
+  } else if (_mca_skip_eval(ctx->sparsity, rng_state, &global_tid)) {
+    return;
+  }
+  _mca_quad_noise(x, -(t - 1), rng_state);
+}
+
 /******************** MCA ARITHMETIC FUNCTIONS ********************
  * The following set of functions perform the MCA operation. Operands
  * are first converted to quad  format (GCC), inbound and outbound
@@ -317,14 +566,212 @@ static void _mca_inexact_binary128(__float128 *qa, void *context) {
 /* Intermediate computations are performed with binary64 */
 inline float _mca_binary32_binary_op(const float a, const float b,
                                      const mca_operations dop, void *context) {
+  _mca_sync_state((t_context *)context);
   _MCA_BINARY_OP(a, b, dop, context, (double)0);
 }
 
 /* Performs mca(a qop b) where a and b are binary64 values */
-/* Intermediate computations are performed with binary128 */
+/* Intermediate computations are performed on binary128 values unpacked */
+/* into integers */
 inline double _mca_binary64_binary_op(const double a, const double b,
                                       const mca_operations qop, void *context) {
-  _MCA_BINARY_OP(a, b, qop, context, (__float128)0);
+  const t_context *ctx = (t_context *)context;
+  _mca_sync_state(ctx);
+  /* reference computation on the __float128 type */
+  if (ctx->quad_binary64) {
+    _MCA_BINARY_OP(a, b, qop, context, (__float128)0);
+  }
+  const double _a = (ctx->daz) ? DAZ(a) : a;
+  const double _b = (ctx->daz) ? DAZ(b) : b;
+  double res = 0;
+  /* the thread-local variables are read once */
+  const mcamode mode = MCALIB_MODE;
+  const int t = MCALIB_BINARY64_T;
+  rng_state_t *rng = &rng_state;
+
+  /* without noise, the binary128 result rounded to binary64 is the */
+  /* binary64 result since 113 >= 2 * 53 + 2 */
+  if (mode == mcamode_ieee) {
+    PERFORM_BIN_OP(qop, res, _a, _b);
+    return (ctx->ftz) ? FTZ(res) : res;
+  }
+
+  /* only the finite non-zero operands are unpacked and perturbed */
+  const bool nonzero_a = isfinite(_a) && _a != 0;
+  const bool nonzero_b = isfinite(_b) && _b != 0;
+  mca_quad_t qa = {0}, qb = {0}, qres = {0};
+  if (nonzero_a) {
+    qa = _mca_quad_unpack(_a);
+    if (mode == mcamode_pb || mode == mcamode_mca) {
+      _mca_inexact_quad(&qa, t, mode, ctx, rng);
+    }
+  }
+  if (nonzero_b) {
+    qb = _mca_quad_unpack(_b);
+    if (mode == mcamode_pb || mode == mcamode_mca) {
+      _mca_inexact_quad(&qb, t, mode, ctx, rng);
+    }
+  }
+
+  if (nonzero_a && nonzero_b) {
+    switch (qop) {
+    case mca_add:
+      qres = _mca_quad_add(qa, qb);
+      break;
+    case mca_sub:
+      qb.sign = !qb.sign;
+      qres = _mca_quad_add(qa, qb);
+      break;
+    case mca_mul:
+      qres = _mca_quad_mul(qa, qb);
+      break;
+    case mca_div:
+      qres = _mca_quad_div(qa, qb);
+      break;
+    default:
+      logger_error("invalid operator %c", qop);
+    }
+  } else if ((qop == mca_add || qop == mca_sub) && (nonzero_a || nonzero_b) &&
+             (_a == 0 || _b == 0)) {
+    /* the sum with a zero is the other operand */
+    qres = (nonzero_a) ? qa : qb;
+    qres.sign ^= (!nonzero_a && qop == mca_sub);
+  } else {
+    /* the zero, infinite and NaN results are not perturbed */
+    PERFORM_BIN_OP(qop, res, _a, _b);
+    return (ctx->ftz) ? FTZ(res) : res;
+  }
+
+  if (qres.mant == 0) {
+    return 0;
+  }
+  if (mode == mcamode_rr || mode == mcamode_mca) {
+    _mca_inexact_quad(&qres, t, mode, ctx, rng);
+  }
+  res = _mca_quad_to_binary64(qres);
+  return (ctx->ftz) ? FTZ(res) : res;
+}
+
+/******************** MCA VECTOR FUNCTIONS ********************
+ * The vector hooks use the AVX2 or AVX-512 kernels generated from
+ * interflop_mca_int_simd.h, with one xoroshiro128++ stream per lane
+ * seeded from the scalar generator of the thread, as in the MCA
+ * backend. binary32 lanes receive the integer noise of
+ * _noise_binary64, DAZ and FTZ being applied with masks. binary64
+ * lanes are computed in double-double, not with the integer binary128
+ * arithmetic, so they do not match the scalar hooks bit for bit; the
+ * lanes out of [MCA_DD_EXP_MIN, MCA_DD_EXP_MAX] use
+ * _mca_binary64_binary_op.
+ ***************************************************************/
+
+/* exponent range of the double-double lanes: their lower parts do not */
+/* underflow and their noise is a normal binary64 */
+#define MCA_DD_EXP_MIN (-DOUBLE_EXP_MIN + 3 * DOUBLE_PREC)
+#define MCA_DD_EXP_MAX (DOUBLE_NORMAL_EXP_MAX - 2)
+
+/* lane-parallel xoroshiro128++ state of the thread */
+static __thread uint64_t _mca_simd_s0[MCA_SIMD_LANES_MAX];
+static __thread uint64_t _mca_simd_s1[MCA_SIMD_LANES_MAX];
+static __thread bool _mca_simd_seeded = false;
+
+typedef void (*mca_simd_binary32_t)(const int size, const float *a,
+                                    const float *b, float *c,
+                                    const mca_operations op, void *context);
+typedef void (*mca_simd_binary64_t)(const int size, const double *a,
+                                    const double *b, double *c,
+                                    const mca_operations op, void *context);
+
+/* kernels selected at initialization, NULL without vector support */
+static mca_simd_binary32_t _mca_simd_binary32 = NULL;
+static mca_simd_binary64_t _mca_simd_binary64 = NULL;
+
+#if MCA_HAVE_SIMD
+#define MCA_SIMD_ISA avx2
+#define MCA_SIMD_TARGET "avx2,fma"
+#define MCA_SIMD_LANES 4
+#define MCA_SIMD_FMA _mm256_fmadd_pd
+#include "interflop_mca_int_simd.h"
+#undef MCA_SIMD_FMA
+#undef MCA_SIMD_LANES
+#undef MCA_SIMD_TARGET
+#undef MCA_SIMD_ISA
+
+#define MCA_SIMD_ISA avx512
+#define MCA_SIMD_TARGET "avx512f"
+#define MCA_SIMD_LANES 8
+#define MCA_SIMD_FMA _mm512_fmadd_pd
+#include "interflop_mca_int_simd.h"
+#undef MCA_SIMD_FMA
+#undef MCA_SIMD_LANES
+#undef MCA_SIMD_TARGET
+#undef MCA_SIMD_ISA
+#endif
+
+/* Selects the kernels of simd, or the widest supported ones for auto */
+static mca_simd _set_mca_simd(mca_simd simd) {
+  simd = _mca_simd_resolve(simd);
+  if (!_mca_simd_supported(simd)) {
+    logger_error("--%s: %s is not supported by this CPU", key_simd_str,
+                 MCA_SIMD_STR[simd]);
+  }
+
+  _mca_simd_binary32 = NULL;
+  _mca_simd_binary64 = NULL;
+#if MCA_HAVE_SIMD
+  if (simd == mca_simd_avx2) {
+    _mca_simd_binary32 = _mca_binary32_vector_avx2;
+    _mca_simd_binary64 = _mca_binary64_vector_avx2;
+  } else if (simd == mca_simd_avx512) {
+    _mca_simd_binary32 = _mca_binary32_vector_avx512;
+    _mca_simd_binary64 = _mca_binary64_vector_avx512;
+  }
+#endif
+  return simd;
+}
+
+/* Seeds the lane streams of the thread from its scalar generator */
+static void _mca_simd_seed(void) {
+  vfc_rng_fill_uint64(&rng_state, _mca_simd_s0, MCA_SIMD_LANES_MAX,
+                      &global_tid);
+  vfc_rng_fill_uint64(&rng_state, _mca_simd_s1, MCA_SIMD_LANES_MAX,
+                      &global_tid);
+  _mca_simd_seeded = true;
+}
+
+/* Performs mca(a[i] op b[i]) for the size binary32 lanes */
+static void _mca_binary32_vector(const int size, const float *a,
+                                 const float *b, float *c,
+                                 const mca_operations op, void *context) {
+  _mca_sync_state((t_context *)context);
+  if (_mca_simd_binary32 == NULL) {
+    for (int i = 0; i < size; i++) {
+      c[i] = _mca_binary32_binary_op(a[i], b[i], op, context);
+    }
+    return;
+  }
+  if (!_mca_simd_seeded) {
+    _mca_simd_seed();
+  }
+  _mca_simd_binary32(size, a, b, c, op, context);
+}
+
+/* Performs mca(a[i] op b[i]) for the size binary64 lanes */
+static void _mca_binary64_vector(const int size, const double *a,
+                                 const double *b, double *c,
+                                 const mca_operations op, void *context) {
+  const t_context *ctx = (t_context *)context;
+  _mca_sync_state(ctx);
+  if (_mca_simd_binary64 == NULL || ctx->quad_binary64 ||
+      MCALIB_BINARY64_T > DOUBLE_PREC) {
+    for (int i = 0; i < size; i++) {
+      c[i] = _mca_binary64_binary_op(a[i], b[i], op, context);
+    }
+    return;
+  }
+  if (!_mca_simd_seeded) {
+    _mca_simd_seed();
+  }
+  _mca_simd_binary64(size, a, b, c, op, context);
 }
 
 /************************* FPHOOKS FUNCTIONS *************************
@@ -349,6 +796,268 @@ _INTERFLOP_OP_CALL(double, mul, mca_mul, _mca_binary64_binary_op)
 
 _INTERFLOP_OP_CALL(double, div, mca_div, _mca_binary64_binary_op)
 
+_INTERFLOP_VECTOR_OP_CALL(float, add, mca_add, _mca_binary32_vector)
+
+_INTERFLOP_VECTOR_OP_CALL(float, sub, mca_sub, _mca_binary32_vector)
+
+_INTERFLOP_VECTOR_OP_CALL(float, mul, mca_mul, _mca_binary32_vector)
+
+_INTERFLOP_VECTOR_OP_CALL(float, div, mca_div, _mca_binary32_vector)
+
+_INTERFLOP_VECTOR_OP_CALL(double, add, mca_add, _mca_binary64_vector)
+
+_INTERFLOP_VECTOR_OP_CALL(double, sub, mca_sub, _mca_binary64_vector)
+
+_INTERFLOP_VECTOR_OP_CALL(double, mul, mca_mul, _mca_binary64_vector)
+
+_INTERFLOP_VECTOR_OP_CALL(double, div, mca_div, _mca_binary64_vector)
+
+/******************** MCA USER CALLS ********************
+ * INTERFLOP_INEXACT_ARRAY_ID perturbs whole arrays: the random numbers
+ * are drawn MCA_INEXACT_ARRAY_CHUNK at a time and the noise is added
+ * to the bits of the values with integer operations, in branch-free
+ * loops that the compiler vectorizes.
+ ***************************************************************/
+
+/* Number of elements perturbed with each buffer of random numbers */
+#define MCA_INEXACT_ARRAY_CHUNK 256
+
+/* Adds rand >> shift to the binary64 bits of the m binary32 values of x */
+/* as _noise_binary64, the values are then rounded to binary32 */
+TARGET_CLONES static void
+_mca_inexact_array_kernel_binary32(float *restrict x,
+                                   const uint64_t *restrict rand,
+                                   const size_t m, const uint32_t shift) {
+  for (size_t j = 0; j < m; j++) {
+    binary64 b64 = {.f64 = x[j]};
+    const uint64_t exp = (b64.u64 >> DOUBLE_PMAN_SIZE) & DOUBLE_EXP_INF;
+    /* zero, infinities and NaN are not perturbed */
+    const int64_t noised =
+        -(int64_t)(((b64.u64 << 1) != 0) & (exp != DOUBLE_EXP_INF));
+    b64.s64 += ((int64_t)rand[j] >> shift) & noised;
+    x[j] = b64.f64;
+  }
+}
+
+/* Adds the noise of _noise_binary128 to the m binary64 values of x */
+/* The binary128 bits of a normal binary64 value are its bits shifted by */
+/* QUAD_PMAN_SIZE - DOUBLE_PMAN_SIZE plus a constant, so the noise, */
+/* rand * 2^-shift binary64 ulps, is added to the binary64 bits and */
+/* rounded to nearest without converting the values to binary128. */
+/* The values of the lowest binade and the subnormal values, for which */
+/* the binary128 and binary64 exponents disagree, are left unchanged and */
+/* flagged in tiny */
+TARGET_CLONES static void
+_mca_inexact_array_kernel_binary64(double *restrict x,
+                                   const uint64_t *restrict rand,
+                                   bool *restrict tiny, const size_t m,
+                                   const uint32_t shift) {
+  const uint64_t half = UINT64_C(1) << (shift - 1);
+  const uint64_t mask = (half << 1) - 1;
+  for (size_t j = 0; j < m; j++) {
+    const binary64 b64 = {.f64 = x[j]};
+    const uint64_t exp = (b64.u64 >> DOUBLE_PMAN_SIZE) & DOUBLE_EXP_INF;
+    const uint64_t rem = rand[j] & mask;
+    int64_t res = b64.s64 + ((int64_t)rand[j] >> shift);
+    /* round to nearest, ties to even: adds 1 if rem > half or if */
+    /* rem == half and res is odd */
+    res += (int64_t)((rem + (half - 1) + (uint64_t)(res & 1)) >> shift);
+    /* overflows are rounded to infinity */
+    const int64_t inf = res & (int64_t)(DOUBLE_PLUS_INF | DOUBLE_GET_SIGN);
+    res = ((res & DOUBLE_PLUS_INF) == DOUBLE_PLUS_INF) ? inf : res;
+    /* zero, infinities and NaN are not perturbed */
+    const int64_t noised = -(int64_t)((exp > 1) & (exp != DOUBLE_EXP_INF));
+    tiny[j] = (exp <= 1) & ((b64.u64 << 1) != 0);
+    const binary64 r64 = {.s64 = (res & noised) | (b64.s64 & ~noised)};
+    x[j] = r64.f64;
+  }
+}
+
+/* Adds the noise of virtual precision t to the n binary32 values of x */
+static void _mca_inexact_array_binary32(float *x, const size_t n,
+                                        const int t) {
+  uint64_t rand[MCA_INEXACT_ARRAY_CHUNK];
+  const uint32_t shift = 1 + DOUBLE_EXP_SIZE + (t - 1);
+  /* the noise is below the binary64 ulp of x */
+  if (shift >= 64) {
+    return;
+  }
+  for (size_t i = 0; i < n; i += MCA_INEXACT_ARRAY_CHUNK) {
+    const size_t m =
+        (n - i < MCA_INEXACT_ARRAY_CHUNK) ? n - i : MCA_INEXACT_ARRAY_CHUNK;
+    vfc_rng_fill_uint64(&rng_state, rand, m, &global_tid);
+    _mca_inexact_array_kernel_binary32(x + i, rand, m, shift);
+  }
+}
+
+/* Adds the noise of virtual precision t to the n binary64 values of x */
+static void _mca_inexact_array_binary64(double *x, const size_t n,
+                                        const int t) {
+  uint64_t rand[MCA_INEXACT_ARRAY_CHUNK];
+  bool tiny[MCA_INEXACT_ARRAY_CHUNK];
+  const uint32_t shift = 1 + DOUBLE_EXP_SIZE + (t - 1);
+  /* the noise is below half the binary64 ulp of x */
+  if (shift >= 64) {
+    return;
+  }
+  for (size_t i = 0; i < n; i += MCA_INEXACT_ARRAY_CHUNK) {
+    const size_t m =
+        (n - i < MCA_INEXACT_ARRAY_CHUNK) ? n - i : MCA_INEXACT_ARRAY_CHUNK;
+    vfc_rng_fill_uint64(&rng_state, rand, m, &global_tid);
+    _mca_inexact_array_kernel_binary64(x + i, rand, tiny, m, shift);
+    for (size_t j = 0; j < m; j++) {
+      if (tiny[j]) {
+        __float128 qa = x[i + j];
+        _noise_binary128(&qa, -(t - 1), &rng_state);
+        x[i + j] = qa;
+      }
+    }
+  }
+}
+
+/* Adds the noise of virtual precision t to the n binary128 values of x */
+static void _mca_inexact_array_binary128(__float128 *x, const size_t n,
+                                         const int t) {
+  for (size_t i = 0; i < n; i++) {
+    if (FPCLASSIFY(x[i]) == FP_NORMAL || FPCLASSIFY(x[i]) == FP_SUBNORMAL) {
+      _noise_binary128(x + i, -(t - 1), &rng_state);
+    }
+  }
+}
+
+/* Adds the noise of virtual precision t to the value of type ftype, */
+/* as one element of INTERFLOP_INEXACT_ARRAY_ID */
+static void _interflop_usercall_inexact(__attribute__((unused)) void *context,
+                                        va_list ap) {
+  const enum FTYPES ftype = va_arg(ap, enum FTYPES);
+  void *value = va_arg(ap, void *);
+  const int precision = va_arg(ap, int);
+  int t = 0;
+
+  if (MCALIB_MODE == mcamode_ieee) {
+    return;
+  }
+
+  switch (ftype) {
+  case FFLOAT:
+    t = (precision <= 0) ? (MCALIB_BINARY32_T + precision) : precision;
+    break;
+  case FDOUBLE:
+  case FQUAD:
+    t = (precision <= 0) ? (MCALIB_BINARY64_T + precision) : precision;
+    break;
+  default:
+    logger_warning(
+        "Unknown type passed to _interflop_usercall_inexact function");
+    return;
+  }
+
+  if (t < MCA_PRECISION_BINARY64_MIN) {
+    logger_error("invalid precision (%d) passed to "
+                 "_interflop_usercall_inexact function",
+                 t);
+  } else if (t > MCA_PRECISION_BINARY64_MAX) {
+    t = MCA_PRECISION_BINARY64_MAX;
+  }
+
+  double xd = 0;
+  __float128 xq = 0;
+  switch (ftype) {
+  case FFLOAT:
+    xd = *((float *)value);
+    /* the noise is below the binary64 ulp of x */
+    if (FPCLASSIFY(xd) == FP_NORMAL && 1 + DOUBLE_EXP_SIZE + (t - 1) < 64) {
+      _noise_binary64(&xd, -(t - 1), &rng_state);
+      *((float *)value) = xd;
+    }
+    break;
+  case FDOUBLE:
+    xq = *((double *)value);
+    if (FPCLASSIFY(xq) == FP_NORMAL || FPCLASSIFY(xq) == FP_SUBNORMAL) {
+      _noise_binary128(&xq, -(t - 1), &rng_state);
+      *((double *)value) = xq;
+    }
+    break;
+  default:
+    xq = *((__float128 *)value);
+    if (FPCLASSIFY(xq) == FP_NORMAL || FPCLASSIFY(xq) == FP_SUBNORMAL) {
+      _noise_binary128(&xq, -(t - 1), &rng_state);
+      *((__float128 *)value) = xq;
+    }
+    break;
+  }
+}
+
+static void _interflop_usercall_inexact_array(__attribute__((unused))
+                                              void *context,
+                                              va_list ap) {
+  const enum FTYPES ftype = va_arg(ap, enum FTYPES);
+  void *value = va_arg(ap, void *);
+  const size_t n = va_arg(ap, size_t);
+  const int precision = va_arg(ap, int);
+  int t = 0;
+
+  if (MCALIB_MODE == mcamode_ieee) {
+    return;
+  }
+
+  switch (ftype) {
+  case FFLOAT:
+    t = (precision <= 0) ? (MCALIB_BINARY32_T + precision) : precision;
+    break;
+  case FDOUBLE:
+  case FQUAD:
+    t = (precision <= 0) ? (MCALIB_BINARY64_T + precision) : precision;
+    break;
+  default:
+    logger_warning(
+        "Unknown type passed to _interflop_usercall_inexact_array function");
+    return;
+  }
+
+  if (t < MCA_PRECISION_BINARY64_MIN) {
+    logger_error("invalid precision (%d) passed to "
+                 "_interflop_usercall_inexact_array function",
+                 t);
+  } else if (t > MCA_PRECISION_BINARY64_MAX) {
+    t = MCA_PRECISION_BINARY64_MAX;
+  }
+
+  switch (ftype) {
+  case FFLOAT:
+    _mca_inexact_array_binary32((float *)value, n, t);
+    break;
+  case FDOUBLE:
+    _mca_inexact_array_binary64((double *)value, n, t);
+    break;
+  default:
+    _mca_inexact_array_binary128((__float128 *)value, n, t);
+    break;
+  }
+}
+
+static void _interflop_user_call(void *context, interflop_call_id id,
+                                 va_list ap) {
+  _mca_sync_state((t_context *)context);
+  switch (id) {
+  case INTERFLOP_INEXACT_ID:
+    _interflop_usercall_inexact(context, ap);
+    break;
+  case INTERFLOP_INEXACT_ARRAY_ID:
+    _interflop_usercall_inexact_array(context, ap);
+    break;
+  case INTERFLOP_SET_PRECISION_BINARY32:
+  case INTERFLOP_SET_PRECISION_BINARY64:
+  case INTERFLOP_SET_RANGE_BINARY32:
+  case INTERFLOP_SET_RANGE_BINARY64:
+    /* the virtual precisions of MCA integer are fixed */
+    break;
+  default:
+    logger_warning("Unknown interflop_call id (=%d)", id);
+    break;
+  }
+}
+
 static struct argp_option options[] = {
     {key_prec_b32_str, KEY_PREC_B32, "PRECISION", 0,
      "select precision for binary32 (PRECISION > 0)", 0},
@@ -363,6 +1072,12 @@ static struct argp_option options[] = {
      0},
     {key_sparsity_str, KEY_SPARSITY, "SPARSITY", 0,
      "one in {sparsity} operations will be perturbed. 0 < sparsity <= 1.", 0},
+    {key_simd_str, KEY_SIMD, "SIMD", 0,
+     "select the vector kernels among {auto, none, avx2, avx512}", 0},
+    {key_quad_binary64_str, KEY_QUAD_BINARY64, 0, 0,
+     "compute binary64 operations with the __float128 type instead of "
+     "integer arithmetic",
+     0},
     {0}};
 
 error_t parse_opt(int key, char *arg, struct argp_state *state) {
@@ -393,13 +1108,13 @@ error_t parse_opt(int key, char *arg, struct argp_state *state) {
   case KEY_MODE:
     /* mca mode */
     if (strcasecmp(MCA_MODE_STR[mcamode_ieee], arg) == 0) {
-      _set_mca_mode(mcamode_ieee);
+      _set_mca_mode(ctx, mcamode_ieee);
     } else if (strcasecmp(MCA_MODE_STR[mcamode_mca], arg) == 0) {
-      _set_mca_mode(mcamode_mca);
+      _set_mca_mode(ctx, mcamode_mca);
     } else if (strcasecmp(MCA_MODE_STR[mcamode_pb], arg) == 0) {
-      _set_mca_mode(mcamode_pb);
+      _set_mca_mode(ctx, mcamode_pb);
     } else if (strcasecmp(MCA_MODE_STR[mcamode_rr], arg) == 0) {
-      _set_mca_mode(mcamode_rr);
+      _set_mca_mode(ctx, mcamode_rr);
     } else {
       logger_error("--%s invalid value provided, must be one of: "
                    "{ieee, mca, pb, rr}.",
@@ -436,6 +1151,24 @@ error_t parse_opt(int key, char *arg, struct argp_state *state) {
                    key_sparsity_str);
     }
     break;
+  case KEY_SIMD:
+    /* vector kernels */
+    ctx->simd = _mca_simd_end_;
+    for (int i = 0; i < _mca_simd_end_; i++) {
+      if (strcasecmp(MCA_SIMD_STR[i], arg) == 0) {
+        ctx->simd = i;
+      }
+    }
+    if (ctx->simd == _mca_simd_end_) {
+      logger_error("--%s invalid value provided, must be one of: "
+                   "{auto, none, avx2, avx512}.",
+                   key_simd_str);
+    }
+    break;
+  case KEY_QUAD_BINARY64:
+    /* __float128 intermediate computations */
+    ctx->quad_binary64 = true;
+    break;
   default:
     return ARGP_ERR_UNKNOWN;
   }
@@ -453,6 +1186,12 @@ void init_context(t_context *ctx) {
   ctx->ftz = false;
   ctx->seed = 0ULL;
   ctx->sparsity = 1.0f;
+  ctx->simd = mca_simd_auto;
+  ctx->quad_binary64 = false;
+  ctx->mode = MCA_MODE_DEFAULT;
+  ctx->binary32_t = MCA_PRECISION_BINARY32_DEFAULT;
+  ctx->binary64_t = MCA_PRECISION_BINARY64_DEFAULT;
+  ctx->generation = 1;
 }
 
 void print_information_header(void *context) {
@@ -465,11 +1204,13 @@ void print_information_header(void *context) {
               "%s = %s, "
               "%s = %d, "
               "%s = %s, "
+              "%s = %s, "
+              "%s = %f, "
               "%s = %s and "
-              "%s = %f"
+              "%s = %s"
               "\n",
-              key_prec_b32_str, MCALIB_BINARY32_T, key_prec_b64_str,
-              MCALIB_BINARY64_T, key_mode_str, MCA_MODE_STR[MCALIB_MODE],
+              key_prec_b32_str, ctx->binary32_t, key_prec_b64_str,
+              ctx->binary64_t, key_mode_str, MCA_MODE_STR[ctx->mode],
               key_err_mode_str,
               (ctx->relErr && !ctx->absErr)
                   ? MCA_ERR_MODE_STR[mca_err_mode_rel]
@@ -480,7 +1221,9 @@ void print_information_header(void *context) {
                               : MCA_ERR_MODE_STR[mca_err_mode_rel],
               key_err_exp_str, (ctx->absErr_exp), key_daz_str,
               ctx->daz ? "true" : "false", key_ftz_str,
-              ctx->ftz ? "true" : "false", key_sparsity_str, ctx->sparsity);
+              ctx->ftz ? "true" : "false", key_sparsity_str, ctx->sparsity,
+              key_simd_str, MCA_SIMD_STR[ctx->simd], key_quad_binary64_str,
+              ctx->quad_binary64 ? "true" : "false");
 }
 
 struct interflop_backend_interface_t interflop_init(int argc, char **argv,
@@ -489,19 +1232,21 @@ struct interflop_backend_interface_t interflop_init(int argc, char **argv,
   /* Initialize the logger */
   logger_init();
 
-  /* Mca integer backend only supports default precision
-     and relative error mode */
-  _set_mca_precision_binary32(MCA_PRECISION_BINARY32_DEFAULT);
-  _set_mca_precision_binary64(MCA_PRECISION_BINARY64_DEFAULT);
-  _set_mca_mode(MCA_MODE_DEFAULT);
-
   t_context *ctx = malloc(sizeof(t_context));
   *context = ctx;
   init_context(ctx);
 
+  /* Mca integer backend only supports default precision
+     and relative error mode */
+  _set_mca_precision_binary32(ctx, MCA_PRECISION_BINARY32_DEFAULT);
+  _set_mca_precision_binary64(ctx, MCA_PRECISION_BINARY64_DEFAULT);
+  _set_mca_mode(ctx, MCA_MODE_DEFAULT);
+
   /* Parse backend arguments */
   argp_parse(&argp, argc, argv, 0, 0, ctx);
 
+  ctx->simd = _set_mca_simd(ctx->simd);
+
   print_information_header(ctx);
 
   struct interflop_backend_interface_t interflop_backend_mca = {
@@ -517,12 +1262,20 @@ struct interflop_backend_interface_t interflop_init(int argc, char **argv,
       NULL,
       NULL,
       NULL,
+      _interflop_user_call,
       NULL,
-      NULL};
+      _interflop_add_float_vector,
+      _interflop_sub_float_vector,
+      _interflop_mul_float_vector,
+      _interflop_div_float_vector,
+      _interflop_add_double_vector,
+      _interflop_sub_double_vector,
+      _interflop_mul_double_vector,
+      _interflop_div_double_vector};
 
   /* The seed for the RNG is initialized upon the first request for a random
      number */
-  _init_rng_state_struct(&rng_state, ctx->choose_seed, ctx->seed, false);
+  vfc_rng_set_seed(ctx->choose_seed, ctx->seed);
 
   return interflop_backend_mca;
 }
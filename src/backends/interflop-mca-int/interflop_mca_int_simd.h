@@ -0,0 +1,252 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2022                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+// Template of the MCA integer vector kernels. It is included by
+// interflop_mca_int.c once per instruction set, with the macros described in
+// common/mca_simd.h which provides the lane helpers.
+//
+// binary32 lanes are computed in binary64 and their noise is added to the
+// binary64 bits with integer operations, as _noise_binary64 does. binary64
+// lanes are computed in double-double, the noise being built from the bits
+// of the random numbers. The lanes which the double-double path cannot
+// process are computed by _mca_binary64_binary_op.
+
+#include "../../common/mca_simd.h"
+
+/* Returns x >> shift with the sign extended in each lane, with logical */
+/* shifts since AVX2 has no 64-bit arithmetic shift */
+_MCA_SIMD_INLINE _VI _MCA_SIMD(_mca_simd_sar)(const _VU x,
+                                              const uint32_t shift) {
+  const uint64_t sign = 1ULL << (63 - shift);
+  return (_VI)(((x >> shift) ^ sign) - sign);
+}
+
+/* Adds rand >> shift to the bits of the lanes of x selected by mask, */
+/* as _noise_binary64 */
+_MCA_SIMD_INLINE _VD _MCA_SIMD(_mca_simd_inexact)(const _VD x,
+                                                  const uint32_t shift,
+                                                  const _VI mask,
+                                                  _VRNG *rng) {
+  const _VI noise =
+      _MCA_SIMD(_mca_simd_sar)(_MCA_SIMD(_mca_simd_next)(rng), shift);
+  return (_VD)((_VI)x + (noise & mask));
+}
+
+/******************** KERNELS ********************/
+
+/* Performs mca(a[i] op b[i]) for the size binary32 lanes */
+/* Intermediate computations are performed with binary64 */
+static __attribute__((target(MCA_SIMD_TARGET))) void
+_MCA_SIMD(_mca_binary32_vector)(const int size, const float *a,
+                                const float *b, float *c,
+                                const mca_operations op, void *context) {
+  const t_context *ctx = (t_context *)context;
+  const int t = MCALIB_BINARY32_T;
+  const uint32_t shift = DOUBLE_EXP_SIZE + t;
+  const uint64_t representable = (1ULL << (DOUBLE_PREC - t)) - 1;
+  const bool inbound = MCALIB_MODE == mcamode_pb || MCALIB_MODE == mcamode_mca;
+  const bool outbound =
+      MCALIB_MODE == mcamode_rr || MCALIB_MODE == mcamode_mca;
+  /* binary64 bits of the smallest normal binary32 */
+  const int64_t binary32_min = (int64_t)(DOUBLE_EXP_COMP - FLOAT_EXP_MIN)
+                               << DOUBLE_PMAN_SIZE;
+
+  _VRNG rng;
+  memcpy(&rng.s0, _mca_simd_s0, sizeof(rng.s0));
+  memcpy(&rng.s1, _mca_simd_s1, sizeof(rng.s1));
+
+  for (int i = 0; i < size; i += MCA_SIMD_LANES) {
+    const int n = (size - i < MCA_SIMD_LANES) ? size - i : MCA_SIMD_LANES;
+    float la[MCA_SIMD_LANES], lb[MCA_SIMD_LANES], lc[MCA_SIMD_LANES];
+    for (int j = 0; j < MCA_SIMD_LANES; j++) {
+      la[j] = (j < n) ? a[i + j] : 1.0f;
+      lb[j] = (j < n) ? b[i + j] : 1.0f;
+    }
+
+    _VF fa, fb;
+    memcpy(&fa, la, sizeof(fa));
+    memcpy(&fb, lb, sizeof(fb));
+    _VD x = __builtin_convertvector(fa, _VD);
+    _VD y = __builtin_convertvector(fb, _VD);
+    _VD res = {0};
+
+    if (ctx->daz) {
+      /* binary32 subnormals are below the smallest normal in binary64 */
+      const _VI x_abs = (_VI)((_VU)x & DOUBLE_ERASE_SIGN);
+      const _VI y_abs = (_VI)((_VU)y & DOUBLE_ERASE_SIGN);
+      x = (_VD)((_VI)x & ~((x_abs != 0) & (x_abs < binary32_min)));
+      y = (_VD)((_VI)y & ~((y_abs != 0) & (y_abs < binary32_min)));
+    }
+
+    if (inbound) {
+      _VI mask = _MCA_SIMD(_mca_simd_is_noised)(x) &
+                 _MCA_SIMD(_mca_simd_sparse)(ctx->sparsity, &rng);
+      x = _MCA_SIMD(_mca_simd_inexact)(x, shift, mask, &rng);
+      mask = _MCA_SIMD(_mca_simd_is_noised)(y) &
+             _MCA_SIMD(_mca_simd_sparse)(ctx->sparsity, &rng);
+      y = _MCA_SIMD(_mca_simd_inexact)(y, shift, mask, &rng);
+    }
+
+    PERFORM_BIN_OP(op, res, x, y);
+
+    if (outbound) {
+      _VI mask = _MCA_SIMD(_mca_simd_is_noised)(res) &
+                 _MCA_SIMD(_mca_simd_sparse)(ctx->sparsity, &rng);
+      if (MCALIB_MODE == mcamode_rr) {
+        mask &=
+            ~_MCA_SIMD(_mca_simd_is_representable)(res, representable);
+      }
+      res = _MCA_SIMD(_mca_simd_inexact)(res, shift, mask, &rng);
+    }
+
+    _VF fc = __builtin_convertvector(res, _VF);
+    if (ctx->ftz) {
+      const _VI32 exp = (_VI32)fc & FLOAT_GET_EXP;
+      const _VI32 mant = (_VI32)fc & FLOAT_GET_PMAN;
+      fc = (_VF)((_VI32)fc & ~((exp == 0) & (mant != 0)));
+    }
+    memcpy(lc, &fc, sizeof(fc));
+    memcpy(c + i, lc, n * sizeof(float));
+  }
+
+  memcpy(_mca_simd_s0, &rng.s0, sizeof(rng.s0));
+  memcpy(_mca_simd_s1, &rng.s1, sizeof(rng.s1));
+}
+
+/* Stores the n lanes of lc which are valid in c, the other ones are */
+/* computed by _mca_binary64_binary_op */
+_MCA_SIMD_INLINE void _MCA_SIMD(_mca_simd_store)(
+    const int n, const double *a, const double *b, double *c,
+    const double *lc, const int64_t *lvalid, const mca_operations op,
+    void *context) {
+  for (int j = 0; j < n; j++) {
+    c[j] = (lvalid[j]) ? lc[j]
+                       : _mca_binary64_binary_op(a[j], b[j], op, context);
+  }
+}
+
+/* Performs mca(a[i] op b[i]) for the size binary64 lanes */
+/* Intermediate computations are performed with double-double */
+static __attribute__((target(MCA_SIMD_TARGET))) void
+_MCA_SIMD(_mca_binary64_vector)(const int size, const double *a,
+                                const double *b, double *c,
+                                const mca_operations op, void *context) {
+  const t_context *ctx = (t_context *)context;
+  const int t = MCALIB_BINARY64_T;
+  const uint64_t representable = (1ULL << (DOUBLE_PREC - t)) - 1;
+  const bool inbound = MCALIB_MODE == mcamode_pb || MCALIB_MODE == mcamode_mca;
+  const bool outbound =
+      MCALIB_MODE == mcamode_rr || MCALIB_MODE == mcamode_mca;
+  const bool zero_sum = op == mca_add || op == mca_sub;
+
+  _VRNG rng;
+  memcpy(&rng.s0, _mca_simd_s0, sizeof(rng.s0));
+  memcpy(&rng.s1, _mca_simd_s1, sizeof(rng.s1));
+
+  for (int i = 0; i < size; i += MCA_SIMD_LANES) {
+    const int n = (size - i < MCA_SIMD_LANES) ? size - i : MCA_SIMD_LANES;
+    double la[MCA_SIMD_LANES], lb[MCA_SIMD_LANES], lc[MCA_SIMD_LANES];
+    int64_t lvalid[MCA_SIMD_LANES];
+    for (int j = 0; j < MCA_SIMD_LANES; j++) {
+      la[j] = (j < n) ? a[i + j] : 1.0;
+      lb[j] = (j < n) ? b[i + j] : 1.0;
+    }
+
+    _VD va, vb, plain = {0};
+    memcpy(&va, la, sizeof(va));
+    memcpy(&vb, lb, sizeof(vb));
+
+    PERFORM_BIN_OP(op, plain, va, vb);
+
+    /* the zero results of sums, and of products and quotients with a zero */
+    /* operand, are exact; the lanes with subnormal operands or results */
+    /* are left to the scalar function which applies DAZ and FTZ */
+    const _VI zero = plain == 0;
+    const _VI zero_valid = zero_sum ? ~(_VI){0} : (va == 0) | (vb == 0);
+    const _VI valid = _MCA_SIMD(_mca_simd_dd_in_range)(va) &
+                      _MCA_SIMD(_mca_simd_dd_in_range)(vb) &
+                      ((zero & zero_valid) |
+                       (~zero & _MCA_SIMD(_mca_simd_dd_in_range)(plain)));
+    memcpy(lvalid, &valid, sizeof(valid));
+
+    /* without noise, the binary64 operation gives the binary128 result */
+    /* rounded to binary64 */
+    if (!inbound && !outbound) {
+      memcpy(lc, &plain, sizeof(plain));
+      _MCA_SIMD(_mca_simd_store)(n, a + i, b + i, c + i, lc, lvalid, op,
+                                 context);
+      continue;
+    }
+
+    _VDD x = {va, (_VD){0}};
+    _VDD y = {vb, (_VD){0}};
+    _VDD res = {(_VD){0}, (_VD){0}};
+
+    if (inbound) {
+      _VI mask = (va != 0) & _MCA_SIMD(_mca_simd_sparse)(ctx->sparsity, &rng);
+      x = _MCA_SIMD(_mca_simd_dd_inexact)(x, t, mask, &rng);
+      mask = (vb != 0) & _MCA_SIMD(_mca_simd_sparse)(ctx->sparsity, &rng);
+      y = _MCA_SIMD(_mca_simd_dd_inexact)(y, t, mask, &rng);
+    }
+
+    switch (op) {
+    case mca_add:
+      res = _MCA_SIMD(_mca_simd_dd_add)(x, y);
+      break;
+    case mca_sub:
+      res = _MCA_SIMD(_mca_simd_dd_add)(x, _MCA_SIMD(_mca_simd_dd_neg)(y));
+      break;
+    case mca_mul:
+      res = _MCA_SIMD(_mca_simd_dd_mul)(x, y);
+      break;
+    case mca_div:
+      res = _MCA_SIMD(_mca_simd_dd_div)(x, y);
+      break;
+    default:
+      logger_error("invalid operator %c", op);
+    }
+
+    /* the error-free transformations lose the sign of zero results */
+    _VD signed_zero = {0};
+    PERFORM_BIN_OP(op, signed_zero, x.hi, y.hi);
+    res.hi = _MCA_SIMD(_mca_simd_select)(res.hi == 0, signed_zero, res.hi);
+
+    if (outbound) {
+      _VI mask = (res.hi != 0) &
+                 _MCA_SIMD(_mca_simd_sparse)(ctx->sparsity, &rng);
+      if (MCALIB_MODE == mcamode_rr) {
+        mask &= ~((res.lo == 0) & _MCA_SIMD(_mca_simd_is_representable)(
+                                      res.hi, representable));
+      }
+      res = _MCA_SIMD(_mca_simd_dd_inexact)(res, t, mask, &rng);
+    }
+
+    memcpy(lc, &res.hi, sizeof(res.hi));
+    _MCA_SIMD(_mca_simd_store)(n, a + i, b + i, c + i, lc, lvalid, op,
+                               context);
+  }
+
+  memcpy(_mca_simd_s0, &rng.s0, sizeof(rng.s0));
+  memcpy(_mca_simd_s1, &rng.s1, sizeof(rng.s1));
+}
+
+#undef _VRNG
+#undef _VDD
+#undef _VI32
+#undef _VF
+#undef _VI
+#undef _VU
+#undef _VD
+#undef _MCA_SIMD_INLINE
+#undef _MCA_SIMD
+#undef _MCA_SIMD_CAT
+#undef _MCA_SIMD_CAT2
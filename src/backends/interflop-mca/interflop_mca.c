@@ -55,6 +55,19 @@
 // id Add FAST_INEXACT macro that is a fast version of the INEXACT macro that
 // does not check if the number is representable or not and thus always
 // introduces a perturbation (for relativeError only)
+//
+// 2026-10-16 binary64 operations are computed in double-double with
+// error-free transformations instead of binary128 when the virtual precision
+// and the exponents allow it. The binary128 path is kept for the other cases
+// and can be forced with --quad-binary64.
+//
+// 2026-10-16 Add vector hooks with AVX2 and AVX-512 kernels, selected at
+// initialization from the features of the CPU. The noise of the lanes is
+// drawn from lane-parallel xoroshiro128++ streams.
+//
+// 2026-10-16 The virtual precisions and the mode are thread-local copies of
+// the ones of the context. INTERFLOP_SET_PRECISION_* user calls only change
+// the precisions of the calling thread, unless --precision-scope=process.
 
 #include <argp.h>
 #include <err.h>
@@ -65,6 +78,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
@@ -75,13 +89,19 @@
 #include "../../common/float_utils.h"
 #include "../../common/interflop.h"
 #include "../../common/logger.h"
+#include "../../common/mca_simd.h"
 #include "../../common/options.h"
 #include "../../common/rng/vfc_rng.h"
+#include "../../common/vfc_hashmap.h"
 
 typedef enum {
   KEY_PREC_B32,
   KEY_PREC_B64,
   KEY_ERR_EXP,
+  KEY_QUAD_BINARY64,
+  KEY_SIMD,
+  KEY_PRECISION_MAP,
+  KEY_PRECISION_SCOPE,
   KEY_MODE = 'm',
   KEY_ERR_MODE = 'e',
   KEY_SEED = 's',
@@ -99,6 +119,10 @@ static const char key_seed_str[] = "seed";
 static const char key_daz_str[] = "daz";
 static const char key_ftz_str[] = "ftz";
 static const char key_sparsity_str[] = "sparsity";
+static const char key_quad_binary64_str[] = "quad-binary64";
+static const char key_simd_str[] = "simd";
+static const char key_precision_map_str[] = "precision-map";
+static const char key_precision_scope_str[] = "precision-scope";
 
 typedef struct {
   bool relErr;
@@ -109,6 +133,16 @@ typedef struct {
   bool daz;
   bool ftz;
   float sparsity;
+  bool quad_binary64;
+  int simd;
+  char *precision_map;
+  int precision_scope;
+  /* virtual precisions and mode copied by the threads, the generation is
+   * incremented when they are changed for all the threads */
+  int mode;
+  int binary32_t;
+  int binary64_t;
+  unsigned int generation;
 } t_context;
 
 /* define the available MCA modes of operation */
@@ -131,6 +165,15 @@ typedef enum {
 
 static const char *MCA_ERR_MODE_STR[] = {"rel", "abs", "all"};
 
+/* define the scopes of the INTERFLOP_SET_PRECISION_* user calls */
+typedef enum {
+  mca_precision_scope_thread,
+  mca_precision_scope_process,
+  _mca_precision_scope_end_
+} mca_precision_scope;
+
+static const char *MCA_PRECISION_SCOPE_STR[] = {"thread", "process"};
+
 /* define default environment variables and default parameters */
 #define MCA_PRECISION_BINARY32_MIN 1
 #define MCA_PRECISION_BINARY64_MIN 1
@@ -140,9 +183,16 @@ static const char *MCA_ERR_MODE_STR[] = {"rel", "abs", "all"};
 #define MCA_PRECISION_BINARY64_DEFAULT 53
 #define MCA_MODE_DEFAULT mcamode_mca
 
-static mcamode MCALIB_MODE = MCA_MODE_DEFAULT;
-static int MCALIB_BINARY32_T = MCA_PRECISION_BINARY32_DEFAULT;
-static int MCALIB_BINARY64_T = MCA_PRECISION_BINARY64_DEFAULT;
+/* thread-local copies of the mode and virtual precisions of the context */
+static __thread mcamode MCALIB_MODE = MCA_MODE_DEFAULT;
+static __thread int MCALIB_BINARY32_T = MCA_PRECISION_BINARY32_DEFAULT;
+static __thread int MCALIB_BINARY64_T = MCA_PRECISION_BINARY64_DEFAULT;
+/* generation of the context copied, 0 until the first copy */
+static __thread unsigned int MCALIB_GENERATION = 0;
+/* precisions of the mapped function run by the thread, 0 if none, they are
+ * applied again after each copy of the context */
+static __thread int MCALIB_MAP_BINARY32_T = 0;
+static __thread int MCALIB_MAP_BINARY64_T = 0;
 
 /* possible operations values */
 typedef enum {
@@ -160,26 +210,81 @@ static double _mca_binary64_binary_op(double a, double b,
 /******************** MCA CONTROL FUNCTIONS *******************
  * The following functions are used to set virtual precision and
  * MCA mode of operation.
+ * The operations read thread-local copies of the ones of the context.
+ * A thread copies them on its first operation and again each time
+ * the generation of the context changes, that is when a user call
+ * changes the precisions with --precision-scope=process.
  ***************************************************************/
 
-/* Set the mca mode */
-static void _set_mca_mode(const mcamode mode) {
+/* Set the mca mode of the context */
+static void _set_mca_mode(t_context *ctx, const mcamode mode) {
   if (mode >= _mcamode_end_) {
     logger_error("--%s invalid value provided, must be one of: "
                  "{ieee, mca, pb, rr}.",
                  key_mode_str);
   }
-  MCALIB_MODE = mode;
+  ctx->mode = mode;
+}
+
+/* Set the virtual precision for binary32 of the context */
+static void _set_mca_precision_binary32(t_context *ctx, const int precision) {
+  _set_precision(MCA, precision, &ctx->binary32_t, (float)0);
+}
+
+/* Set the virtual precision for binary64 of the context */
+static void _set_mca_precision_binary64(t_context *ctx, const int precision) {
+  _set_precision(MCA, precision, &ctx->binary64_t, (double)0);
+}
+
+/* Copies the mode and virtual precisions of the context in the thread */
+static void _mca_load_state(const t_context *ctx) {
+  MCALIB_GENERATION = __atomic_load_n(&ctx->generation, __ATOMIC_ACQUIRE);
+  MCALIB_MODE = __atomic_load_n(&ctx->mode, __ATOMIC_RELAXED);
+  MCALIB_BINARY32_T = __atomic_load_n(&ctx->binary32_t, __ATOMIC_RELAXED);
+  MCALIB_BINARY64_T = __atomic_load_n(&ctx->binary64_t, __ATOMIC_RELAXED);
+  if (MCALIB_MAP_BINARY32_T > 0) {
+    MCALIB_BINARY32_T = MCALIB_MAP_BINARY32_T;
+  }
+  if (MCALIB_MAP_BINARY64_T > 0) {
+    MCALIB_BINARY64_T = MCALIB_MAP_BINARY64_T;
+  }
+}
+
+/* Updates the thread-local state if the one of the context has changed */
+static inline void _mca_sync_state(const t_context *ctx) {
+  const unsigned int generation =
+      __atomic_load_n(&ctx->generation, __ATOMIC_RELAXED);
+  if (generation != MCALIB_GENERATION) {
+    _mca_load_state(ctx);
+  }
 }
 
-/* Set the virtual precision for binary32 */
-static void _set_mca_precision_binary32(const int precision) {
-  _set_precision(MCA, precision, &MCALIB_BINARY32_T, (float)0);
+/* Set the virtual precision for binary32 from a user call, for the calling
+ * thread or for all the threads with --precision-scope=process */
+static void _usercall_set_precision_binary32(t_context *ctx,
+                                             const int precision) {
+  if (ctx->precision_scope == mca_precision_scope_process) {
+    int t;
+    _set_precision(MCA, precision, &t, (float)0);
+    __atomic_store_n(&ctx->binary32_t, t, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&ctx->generation, 1, __ATOMIC_RELEASE);
+  } else {
+    _set_precision(MCA, precision, &MCALIB_BINARY32_T, (float)0);
+  }
 }
 
-/* Set the virtual precision for binary64 */
-static void _set_mca_precision_binary64(const int precision) {
-  _set_precision(MCA, precision, &MCALIB_BINARY64_T, (double)0);
+/* Set the virtual precision for binary64 from a user call, for the calling
+ * thread or for all the threads with --precision-scope=process */
+static void _usercall_set_precision_binary64(t_context *ctx,
+                                             const int precision) {
+  if (ctx->precision_scope == mca_precision_scope_process) {
+    int t;
+    _set_precision(MCA, precision, &t, (double)0);
+    __atomic_store_n(&ctx->binary64_t, t, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&ctx->generation, 1, __ATOMIC_RELEASE);
+  } else {
+    _set_precision(MCA, precision, &MCALIB_BINARY64_T, (double)0);
+  }
 }
 
 /******************** MCA RANDOM FUNCTIONS ********************
@@ -254,9 +359,6 @@ static __float128 _noise_binary128(const int exp, rng_state_t *rng_state) {
     if (_IS_IEEE_MODE() || _IS_NOT_NORMAL_OR_SUBNORMAL(*X)) {                  \
       return;                                                                  \
     }                                                                          \
-    t_context *TMP_CTX = (t_context *)CTX;                                     \
-    _init_rng_state_struct(&RNG_STATE, TMP_CTX->choose_seed,                   \
-                           (unsigned long long)(TMP_CTX->seed), false);        \
     const int32_t e_a = GET_EXP_FLT(*X);                                       \
     const int32_t e_n_rel = e_a - (VIRTUAL_PRECISION - 1);                     \
     const typeof(*X) noise_rel = _NOISE(*X, e_n_rel, &RNG_STATE);              \
@@ -268,8 +370,6 @@ static __float128 _noise_binary128(const int exp, rng_state_t *rng_state) {
 #define _INEXACT(X, VIRTUAL_PRECISION, CTX, RNG_STATE)                         \
   {                                                                            \
     t_context *TMP_CTX = (t_context *)CTX;                                     \
-    _init_rng_state_struct(&RNG_STATE, TMP_CTX->choose_seed,                   \
-                           (unsigned long long)(TMP_CTX->seed), false);        \
     if (_MUST_NOT_BE_NOISED(*X, VIRTUAL_PRECISION)) {                          \
       return;                                                                  \
     } else if (_mca_skip_eval(TMP_CTX->sparsity, &(RNG_STATE), &global_tid)) { \
@@ -358,20 +458,325 @@ static void _mca_inexact_binary128(__float128 *qa, void *context) {
     return (typeof(A))(_RES);                                                  \
   } while (0);
 
+/******************** MCA DOUBLE-DOUBLE FUNCTIONS ********************
+ * binary64 operations are computed on double-double numbers, the
+ * unevaluated sum hi + lo of two binary64 with |lo| <= ulp(hi) / 2.
+ * Operands perturbed by a noise of precision up to 53 bits are exact
+ * double-double numbers, built with the TwoSum error-free
+ * transformation, and the results of the operations on them have a
+ * relative error below 2^-104, TwoProd being computed with a fused
+ * multiply-add. The noise is then added at the exponent of the result
+ * and the sum is rounded to binary64, as the binary128 path does,
+ * without its software emulation.
+ *
+ * The lower part must not underflow and the noise must be a normal
+ * binary64: this path is only taken when the exponents of the operands
+ * and of the result are in [MCA_DD_EXP_MIN, MCA_DD_EXP_MAX], for the
+ * relative error mode and virtual precisions up to 53 bits.
+ **********************************************************************/
+
+#define MCA_DD_EXP_MIN (-DOUBLE_EXP_MIN + 3 * DOUBLE_PREC)
+#define MCA_DD_EXP_MAX (DOUBLE_NORMAL_EXP_MAX - 2)
+
+typedef struct {
+  double hi;
+  double lo;
+} mca_dd_t;
+
+/* s + e = a + b exactly */
+static inline mca_dd_t _mca_two_sum(const double a, const double b) {
+  const double s = a + b;
+  const double bb = s - a;
+  const double e = (a - (s - bb)) + (b - bb);
+  return (mca_dd_t){s, e};
+}
+
+/* s + e = a + b exactly, assuming |a| >= |b| */
+static inline mca_dd_t _mca_fast_two_sum(const double a, const double b) {
+  const double s = a + b;
+  const double e = b - (s - a);
+  return (mca_dd_t){s, e};
+}
+
+/* p + e = a * b exactly */
+static inline mca_dd_t _mca_two_prod(const double a, const double b) {
+  const double p = a * b;
+  const double e = fma(a, b, -p);
+  return (mca_dd_t){p, e};
+}
+
+static inline mca_dd_t _mca_dd_add_d(const mca_dd_t x, const double b) {
+  mca_dd_t s = _mca_two_sum(x.hi, b);
+  s.lo += x.lo;
+  return _mca_fast_two_sum(s.hi, s.lo);
+}
+
+static inline mca_dd_t _mca_dd_add(const mca_dd_t x, const mca_dd_t y) {
+  mca_dd_t s = _mca_two_sum(x.hi, y.hi);
+  const mca_dd_t t = _mca_two_sum(x.lo, y.lo);
+  s.lo += t.hi;
+  s = _mca_fast_two_sum(s.hi, s.lo);
+  s.lo += t.lo;
+  return _mca_fast_two_sum(s.hi, s.lo);
+}
+
+static inline mca_dd_t _mca_dd_neg(const mca_dd_t x) {
+  return (mca_dd_t){-x.hi, -x.lo};
+}
+
+static inline mca_dd_t _mca_dd_mul_d(const mca_dd_t x, const double b) {
+  mca_dd_t p = _mca_two_prod(x.hi, b);
+  p.lo += x.lo * b;
+  return _mca_fast_two_sum(p.hi, p.lo);
+}
+
+static inline mca_dd_t _mca_dd_mul(const mca_dd_t x, const mca_dd_t y) {
+  mca_dd_t p = _mca_two_prod(x.hi, y.hi);
+  p.lo += fma(x.hi, y.lo, x.lo * y.hi);
+  return _mca_fast_two_sum(p.hi, p.lo);
+}
+
+/* The quotient of the leading parts is refined twice with the remainder */
+static inline mca_dd_t _mca_dd_div(const mca_dd_t x, const mca_dd_t y) {
+  const double q1 = x.hi / y.hi;
+  mca_dd_t r = _mca_dd_add(x, _mca_dd_neg(_mca_dd_mul_d(y, q1)));
+  const double q2 = r.hi / y.hi;
+  r = _mca_dd_add(r, _mca_dd_neg(_mca_dd_mul_d(y, q2)));
+  const double q3 = r.hi / y.hi;
+  return _mca_dd_add_d(_mca_fast_two_sum(q1, q2), q3);
+}
+
+/* Returns the unbiased exponent of the exact value hi + lo */
+static inline int32_t _mca_dd_exponent(const mca_dd_t x) {
+  const binary64 b64 = {.f64 = x.hi};
+  const int32_t e = b64.ieee.exponent - DOUBLE_EXP_COMP;
+  /* hi is a power of two rounded up from hi + lo */
+  if (b64.ieee.mantissa == 0 && x.lo != 0 && signbit(x.lo) != signbit(x.hi))
+    return e - 1;
+  return e;
+}
+
+/* Return true if x can be processed by the double-double path */
+static inline bool _mca_dd_in_range(const double x) {
+  if (x == 0)
+    return true;
+  const int32_t e = GET_EXP_FLT(x);
+  return MCA_DD_EXP_MIN <= e && e <= MCA_DD_EXP_MAX;
+}
+
+/* Return true if mca(a op b) can be computed in double-double */
+static inline bool _mca_dd_is_valid(const double a, const double b,
+                                    const mca_operations op,
+                                    const t_context *ctx) {
+  if (ctx->quad_binary64 || ctx->absErr || MCALIB_BINARY64_T > DOUBLE_PREC)
+    return false;
+  if (!_mca_dd_in_range(a) || !_mca_dd_in_range(b))
+    return false;
+  double res = 0;
+  PERFORM_BIN_OP(op, res, a, b);
+  /* a zero product or quotient of non-zero operands has underflowed */
+  if (res == 0)
+    return op == mca_add || op == mca_sub || a == 0 || b == 0;
+  return _mca_dd_in_range(res);
+}
+
+/* Adds the mca noise to x, the double-double counterpart of _INEXACT */
+static inline void _mca_inexact_binary64_dd(mca_dd_t *x, void *context) {
+  t_context *ctx = (t_context *)context;
+  if (_IS_IEEE_MODE() || x->hi == 0) {
+    return;
+  } else if (MCALIB_MODE == mcamode_rr && x->lo == 0 &&
+             _IS_REPRESENTABLE(x->hi, MCALIB_BINARY64_T)) {
+    return;
+  } else if (_mca_skip_eval(ctx->sparsity, &rng_state, &global_tid)) {
+    return;
+  } else if (ctx->relErr) {
+    const int32_t e_n_rel = _mca_dd_exponent(*x) - (MCALIB_BINARY64_T - 1);
+    *x = _mca_dd_add_d(*x, _noise_binary64(e_n_rel, &rng_state));
+  }
+}
+
+/* Performs mca(a op b) in double-double, follows _MCA_BINARY_OP */
+static inline double _mca_dd_binary_op(const double a, const double b,
+                                       const mca_operations op,
+                                       void *context) {
+  mca_dd_t x = {a, 0};
+  mca_dd_t y = {b, 0};
+  mca_dd_t res = {0, 0};
+  if (MCALIB_MODE == mcamode_pb || MCALIB_MODE == mcamode_mca) {
+    _mca_inexact_binary64_dd(&x, context);
+    _mca_inexact_binary64_dd(&y, context);
+  }
+  switch (op) {
+  case mca_add:
+    res = _mca_dd_add(x, y);
+    break;
+  case mca_sub:
+    res = _mca_dd_add(x, _mca_dd_neg(y));
+    break;
+  case mca_mul:
+    res = _mca_dd_mul(x, y);
+    break;
+  case mca_div:
+    res = _mca_dd_div(x, y);
+    break;
+  default:
+    logger_error("invalid operator %c", op);
+  }
+  /* the error-free transformations lose the sign of zero results */
+  if (res.hi == 0) {
+    PERFORM_BIN_OP(op, res.hi, x.hi, y.hi);
+  }
+  if (MCALIB_MODE == mcamode_rr || MCALIB_MODE == mcamode_mca) {
+    _mca_inexact_binary64_dd(&res, context);
+  }
+  /* res is normalized, hi is the rounding of hi + lo */
+  return res.hi;
+}
+
 /* Performs mca(a dop b) where a and b are binary32 values */
 /* Intermediate computations are performed with binary64 */
 inline float _mca_binary32_binary_op(const float a, const float b,
                                      const mca_operations dop, void *context) {
+  _mca_sync_state((t_context *)context);
   _MCA_BINARY_OP(a, b, dop, context, (double)0);
 }
 
 /* Performs mca(a qop b) where a and b are binary64 values */
-/* Intermediate computations are performed with binary128 */
+/* Intermediate computations are performed with double-double when possible */
+/* and with binary128 otherwise */
 inline double _mca_binary64_binary_op(const double a, const double b,
                                       const mca_operations qop, void *context) {
+  const t_context *ctx = (t_context *)context;
+  _mca_sync_state(ctx);
+  const double _a = (ctx->daz) ? DAZ(a) : a;
+  const double _b = (ctx->daz) ? DAZ(b) : b;
+  if (_mca_dd_is_valid(_a, _b, qop, ctx)) {
+    /* results in the double-double range are never subnormal, no FTZ */
+    return _mca_dd_binary_op(_a, _b, qop, context);
+  }
   _MCA_BINARY_OP(a, b, qop, context, (__float128)0);
 }
 
+/******************** MCA VECTOR FUNCTIONS ********************
+ * The vector hooks compute 4 (AVX2) or 8 (AVX-512) lanes with each
+ * instruction, the kernels are generated from interflop_mca_simd.h
+ * and selected at initialization. Each lane draws its noise from its
+ * own xoroshiro128++ stream; the streams of a thread are seeded from
+ * its scalar generator, so the results are reproducible with --seed
+ * but differ from the ones of the scalar hooks.
+ *
+ * The absolute error mode, the binary128 path and DAZ/FTZ for
+ * binary32 are not vectorized: these operations are computed with
+ * the scalar functions, one lane at a time.
+ ***************************************************************/
+
+/* lane-parallel xoroshiro128++ state of the thread */
+static __thread uint64_t _mca_simd_s0[MCA_SIMD_LANES_MAX];
+static __thread uint64_t _mca_simd_s1[MCA_SIMD_LANES_MAX];
+static __thread bool _mca_simd_seeded = false;
+
+typedef void (*mca_simd_binary32_t)(const int size, const float *a,
+                                    const float *b, float *c,
+                                    const mca_operations op, void *context);
+typedef void (*mca_simd_binary64_t)(const int size, const double *a,
+                                    const double *b, double *c,
+                                    const mca_operations op, void *context);
+
+/* kernels selected at initialization, NULL without vector support */
+static mca_simd_binary32_t _mca_simd_binary32 = NULL;
+static mca_simd_binary64_t _mca_simd_binary64 = NULL;
+
+#if MCA_HAVE_SIMD
+#define MCA_SIMD_ISA avx2
+#define MCA_SIMD_TARGET "avx2,fma"
+#define MCA_SIMD_LANES 4
+#define MCA_SIMD_FMA _mm256_fmadd_pd
+#include "interflop_mca_simd.h"
+#undef MCA_SIMD_FMA
+#undef MCA_SIMD_LANES
+#undef MCA_SIMD_TARGET
+#undef MCA_SIMD_ISA
+
+#define MCA_SIMD_ISA avx512
+#define MCA_SIMD_TARGET "avx512f"
+#define MCA_SIMD_LANES 8
+#define MCA_SIMD_FMA _mm512_fmadd_pd
+#include "interflop_mca_simd.h"
+#undef MCA_SIMD_FMA
+#undef MCA_SIMD_LANES
+#undef MCA_SIMD_TARGET
+#undef MCA_SIMD_ISA
+#endif
+
+/* Selects the kernels of simd, or the widest supported ones for auto */
+static mca_simd _set_mca_simd(mca_simd simd) {
+  simd = _mca_simd_resolve(simd);
+  if (!_mca_simd_supported(simd)) {
+    logger_error("--%s: %s is not supported by this CPU", key_simd_str,
+                 MCA_SIMD_STR[simd]);
+  }
+
+  _mca_simd_binary32 = NULL;
+  _mca_simd_binary64 = NULL;
+#if MCA_HAVE_SIMD
+  if (simd == mca_simd_avx2) {
+    _mca_simd_binary32 = _mca_binary32_vector_avx2;
+    _mca_simd_binary64 = _mca_binary64_vector_avx2;
+  } else if (simd == mca_simd_avx512) {
+    _mca_simd_binary32 = _mca_binary32_vector_avx512;
+    _mca_simd_binary64 = _mca_binary64_vector_avx512;
+  }
+#endif
+  return simd;
+}
+
+/* Seeds the lane streams of the thread from its scalar generator */
+static void _mca_simd_seed(void) {
+  vfc_rng_fill_uint64(&rng_state, _mca_simd_s0, MCA_SIMD_LANES_MAX,
+                      &global_tid);
+  vfc_rng_fill_uint64(&rng_state, _mca_simd_s1, MCA_SIMD_LANES_MAX,
+                      &global_tid);
+  _mca_simd_seeded = true;
+}
+
+/* Performs mca(a[i] op b[i]) for the size binary32 lanes */
+static void _mca_binary32_vector(const int size, const float *a,
+                                 const float *b, float *c,
+                                 const mca_operations op, void *context) {
+  const t_context *ctx = (t_context *)context;
+  _mca_sync_state(ctx);
+  if (_mca_simd_binary32 == NULL || ctx->absErr || ctx->daz || ctx->ftz) {
+    for (int i = 0; i < size; i++) {
+      c[i] = _mca_binary32_binary_op(a[i], b[i], op, context);
+    }
+    return;
+  }
+  if (!_mca_simd_seeded) {
+    _mca_simd_seed();
+  }
+  _mca_simd_binary32(size, a, b, c, op, context);
+}
+
+/* Performs mca(a[i] op b[i]) for the size binary64 lanes */
+static void _mca_binary64_vector(const int size, const double *a,
+                                 const double *b, double *c,
+                                 const mca_operations op, void *context) {
+  const t_context *ctx = (t_context *)context;
+  _mca_sync_state(ctx);
+  if (_mca_simd_binary64 == NULL || ctx->absErr || ctx->quad_binary64 ||
+      MCALIB_BINARY64_T > DOUBLE_PREC) {
+    for (int i = 0; i < size; i++) {
+      c[i] = _mca_binary64_binary_op(a[i], b[i], op, context);
+    }
+    return;
+  }
+  if (!_mca_simd_seeded) {
+    _mca_simd_seed();
+  }
+  _mca_simd_binary64(size, a, b, c, op, context);
+}
+
 /************************* FPHOOKS FUNCTIONS *************************
  * These functions correspond to those inserted into the source code
  * during source to source compilation and are replacement to floating
@@ -394,7 +799,24 @@ _INTERFLOP_OP_CALL(double, mul, mca_mul, _mca_binary64_binary_op)
 
 _INTERFLOP_OP_CALL(double, div, mca_div, _mca_binary64_binary_op)
 
-void _interflop_usercall_inexact(void *context, va_list ap) {
+_INTERFLOP_VECTOR_OP_CALL(float, add, mca_add, _mca_binary32_vector)
+
+_INTERFLOP_VECTOR_OP_CALL(float, sub, mca_sub, _mca_binary32_vector)
+
+_INTERFLOP_VECTOR_OP_CALL(float, mul, mca_mul, _mca_binary32_vector)
+
+_INTERFLOP_VECTOR_OP_CALL(float, div, mca_div, _mca_binary32_vector)
+
+_INTERFLOP_VECTOR_OP_CALL(double, add, mca_add, _mca_binary64_vector)
+
+_INTERFLOP_VECTOR_OP_CALL(double, sub, mca_sub, _mca_binary64_vector)
+
+_INTERFLOP_VECTOR_OP_CALL(double, mul, mca_mul, _mca_binary64_vector)
+
+_INTERFLOP_VECTOR_OP_CALL(double, div, mca_div, _mca_binary64_vector)
+
+void _interflop_usercall_inexact(__attribute__((unused)) void *context,
+                                 va_list ap) {
   double xd = 0;
   __float128 xq = 0;
   enum FTYPES ftype;
@@ -428,16 +850,149 @@ void _interflop_usercall_inexact(void *context, va_list ap) {
   }
 }
 
+/* Number of elements perturbed with each buffer of random numbers */
+#define MCA_INEXACT_ARRAY_CHUNK 256
+
+/* Returns x + rand * 2^(e_x - (t - 1)), the noise of _FAST_INEXACT with */
+/* rand = r - 0.5 in [-0.5, 0.5), or x when x is zero or not finite. */
+/* The noise is scaled by 2^(k + 128) * 2^-128 when 2^k is subnormal. */
+/* The fields are read and selected with integer operations so that the */
+/* loops of the _mca_inexact_array_kernel_* functions are vectorized */
+static inline double _mca_inexact_array_noise(const double x, const double r,
+                                              const int t) {
+  const binary64 b64 = {.f64 = x};
+  const uint64_t e_x = (b64.u64 >> DOUBLE_PMAN_SIZE) & DOUBLE_EXP_INF;
+  /* biased exponent of the noise */
+  const int64_t k = (int64_t)e_x - (t - 1);
+  const int64_t scale = (k < 1) ? 128 : 0;
+  const binary64 pow2_k = {.u64 = (uint64_t)(k + scale) << DOUBLE_PMAN_SIZE};
+  const binary64 pow2_s = {.u64 = (uint64_t)(DOUBLE_EXP_COMP - scale)
+                                  << DOUBLE_PMAN_SIZE};
+  binary64 res = {.f64 = x + ((r - 0.5) * pow2_k.f64) * pow2_s.f64};
+  const uint64_t keep =
+      -(uint64_t)(((b64.u64 << 1) == 0) | (e_x == DOUBLE_EXP_INF));
+  res.u64 = (res.u64 & ~keep) | (b64.u64 & keep);
+  return res.f64;
+}
+
+/* Adds the noise of virtual precision t to the m binary32 values of x */
+/* The values are perturbed in binary64 as in _interflop_usercall_inexact */
+TARGET_CLONES static void
+_mca_inexact_array_kernel_binary32(float *restrict x,
+                                   const double *restrict rand,
+                                   const size_t m, const int t) {
+  for (size_t j = 0; j < m; j++) {
+    x[j] = _mca_inexact_array_noise(x[j], rand[j], t);
+  }
+}
+
+/* Adds the noise of virtual precision t to the m binary64 values of x */
+/* The sum is rounded once: the result is the one of the binary128 */
+/* intermediate of _interflop_usercall_inexact, for which the sum is */
+/* exact, unless the noise is subnormal or t > 60 */
+TARGET_CLONES static void
+_mca_inexact_array_kernel_binary64(double *restrict x,
+                                   const double *restrict rand,
+                                   const size_t m, const int t) {
+  for (size_t j = 0; j < m; j++) {
+    x[j] = _mca_inexact_array_noise(x[j], rand[j], t);
+  }
+}
+
+/* Perturbs the N values of X with KERNEL, the random numbers are drawn */
+/* MCA_INEXACT_ARRAY_CHUNK at a time */
+#define _INEXACT_ARRAY(X, N, T, KERNEL)                                        \
+  {                                                                            \
+    double rand[MCA_INEXACT_ARRAY_CHUNK];                                      \
+    for (size_t i = 0; i < N; i += MCA_INEXACT_ARRAY_CHUNK) {                  \
+      const size_t m =                                                         \
+          (N - i < MCA_INEXACT_ARRAY_CHUNK) ? N - i : MCA_INEXACT_ARRAY_CHUNK; \
+      vfc_rng_fill_double01(&rng_state, rand, m, &global_tid);                 \
+      KERNEL(X + i, rand, m, T);                                               \
+    }                                                                          \
+  }
+
+static void _mca_inexact_array_binary32(float *x, const size_t n,
+                                        const int t) {
+  _INEXACT_ARRAY(x, n, t, _mca_inexact_array_kernel_binary32);
+}
+
+static void _mca_inexact_array_binary64(double *x, const size_t n,
+                                        const int t) {
+  _INEXACT_ARRAY(x, n, t, _mca_inexact_array_kernel_binary64);
+}
+
+/* Adds the noise of virtual precision t to the binary128 value x */
+static void _mca_fast_inexact_binary128(__float128 *x, const int t) {
+  _FAST_INEXACT(x, t, NULL, rng_state);
+}
+
+void _interflop_usercall_inexact_array(__attribute__((unused)) void *context,
+                                       va_list ap) {
+  const enum FTYPES ftype = va_arg(ap, enum FTYPES);
+  void *value = va_arg(ap, void *);
+  const size_t n = va_arg(ap, size_t);
+  const int precision = va_arg(ap, int);
+  int t = 0;
+
+  if (_IS_IEEE_MODE()) {
+    return;
+  }
+
+  switch (ftype) {
+  case FFLOAT:
+    t = (precision <= 0) ? (MCALIB_BINARY32_T + precision) : precision;
+    break;
+  case FDOUBLE:
+    t = (precision <= 0) ? (MCALIB_BINARY64_T + precision) : precision;
+    break;
+  case FQUAD:
+    t = precision;
+    break;
+  default:
+    logger_warning(
+        "Unknown type passed to _interflop_usercall_inexact_array function");
+    return;
+  }
+
+  if (t < MCA_PRECISION_BINARY64_MIN) {
+    logger_error("invalid precision (%d) passed to "
+                 "_interflop_usercall_inexact_array function",
+                 t);
+  } else if (t > MCA_PRECISION_BINARY64_MAX) {
+    /* the noise is below the precision of the binary128 intermediate */
+    t = MCA_PRECISION_BINARY64_MAX;
+  }
+
+  switch (ftype) {
+  case FFLOAT:
+    _mca_inexact_array_binary32((float *)value, n, t);
+    break;
+  case FDOUBLE:
+    _mca_inexact_array_binary64((double *)value, n, t);
+    break;
+  default:
+    for (size_t i = 0; i < n; i++) {
+      _mca_fast_inexact_binary128((__float128 *)value + i, t);
+    }
+    break;
+  }
+}
+
 void _interflop_user_call(void *context, interflop_call_id id, va_list ap) {
+  _mca_sync_state((t_context *)context);
   switch (id) {
   case INTERFLOP_INEXACT_ID:
     _interflop_usercall_inexact(context, ap);
     break;
+  case INTERFLOP_INEXACT_ARRAY_ID:
+    _interflop_usercall_inexact_array(context, ap);
+    break;
   case INTERFLOP_SET_PRECISION_BINARY32:
-    _set_mca_precision_binary32(va_arg(ap, int));
+    _usercall_set_precision_binary32(context, va_arg(ap, int));
     break;
   case INTERFLOP_SET_PRECISION_BINARY64:
-    _set_mca_precision_binary64(va_arg(ap, int));
+    _usercall_set_precision_binary64(context, va_arg(ap, int));
     break;
   default:
     logger_warning("Unknown interflop_call id (=%d)", id);
@@ -445,6 +1000,252 @@ void _interflop_user_call(void *context, interflop_call_id id, va_list ap) {
   }
 }
 
+/******************** MCA PRECISION MAP ********************
+ * With --precision-map, the virtual precisions are set on entry of the
+ * functions and call sites listed in a file, and restored on exit. The
+ * hooks are called by the function instrumentation (--inst-func).
+ ***************************************************************/
+
+/* Virtual precisions of a function or call site, a binary32 precision of 0
+ * keeps the one of the caller */
+typedef struct {
+  char *id;
+  int binary64;
+  int binary32;
+} mca_precision_map_entry_t;
+
+/* Entries of the map, keyed by the hash of their function name or call site
+ * identifier */
+static vfc_hashmap_t _mca_precision_map = NULL;
+
+/* Entries of the call sites indexed by the dense index of their descriptor,
+ * the map is only searched the first time a call site is seen. The table is
+ * split in chunks which are never moved, so that threads can read it while
+ * another one adds an entry. */
+#define _MCA_MAP_CHUNK_SIZE 1024
+#define _MCA_MAP_CHUNK_NUMBER 4096
+static mca_precision_map_entry_t **_mca_map_table[_MCA_MAP_CHUNK_NUMBER];
+static char _mca_map_table_lock = 0;
+
+/* Entry of the call sites which are not in the map */
+static mca_precision_map_entry_t _mca_map_none = {NULL, 0, 0};
+
+/* Precisions of the callers of the mapped functions entered by the thread,
+ * four per call: the binary64 and binary32 precisions, then the ones of the
+ * mapped function run by the caller */
+#define _MCA_MAP_FRAME_SIZE 4
+static __thread int *_mca_map_stack = NULL;
+static __thread int _mca_map_stack_size = 0;
+static __thread int _mca_map_stack_top = 0;
+
+/* Key whose destructor frees the precision map stack of a thread when it
+ * exits */
+static pthread_key_t _mca_map_stack_key;
+
+static void _mca_map_stack_free(__attribute__((unused)) void *stack) {
+  free(_mca_map_stack);
+  _mca_map_stack = NULL;
+  _mca_map_stack_size = 0;
+  _mca_map_stack_top = 0;
+}
+
+/* Returns the entry of id, NULL if it is not in the map */
+static mca_precision_map_entry_t *_mca_map_find(const char *id) {
+  mca_precision_map_entry_t *entry =
+      vfc_hashmap_get(_mca_precision_map, vfc_hashmap_str_function(id));
+  return (entry != NULL && strcmp(entry->id, id) == 0) ? entry : NULL;
+}
+
+/* Returns the entry of a call site: the entry of its identifier, else the
+ * entry of the called function. Identifiers are file/caller/callee/line/n,
+ * where the file may contain slashes. */
+static mca_precision_map_entry_t *
+_mca_map_resolve(interflop_function_info_t *function_info) {
+  const char *id = function_info->id;
+  mca_precision_map_entry_t *entry = _mca_map_find(id);
+  if (entry != NULL) {
+    return entry;
+  }
+
+  const char *end = id + strlen(id);
+  const char *slash[3] = {NULL, NULL, NULL};
+  int found = 0;
+  for (const char *c = end - 1; c >= id && found < 3; c--) {
+    if (*c == '/') {
+      slash[found++] = c;
+    }
+  }
+  if (found < 3 || slash[1] - slash[2] <= 1) {
+    return &_mca_map_none;
+  }
+
+  const size_t length = slash[1] - slash[2] - 1;
+  char *name = malloc(length + 1);
+  memcpy(name, slash[2] + 1, length);
+  name[length] = '\0';
+  entry = _mca_map_find(name);
+  free(name);
+
+  return (entry != NULL) ? entry : &_mca_map_none;
+}
+
+/* Returns the entry of a call site, resolved on its first call */
+static mca_precision_map_entry_t *
+_mca_map_get(interflop_function_info_t *function_info) {
+  const int index = function_info->index;
+  const int chunk = index / _MCA_MAP_CHUNK_SIZE;
+  const int offset = index % _MCA_MAP_CHUNK_SIZE;
+  /* descriptors which were not registered are always resolved by name */
+  const int indexed = (index >= 0 && chunk < _MCA_MAP_CHUNK_NUMBER);
+
+  if (!indexed) {
+    return _mca_map_resolve(function_info);
+  }
+
+  mca_precision_map_entry_t **entries =
+      __atomic_load_n(&_mca_map_table[chunk], __ATOMIC_ACQUIRE);
+  if (entries != NULL) {
+    mca_precision_map_entry_t *entry =
+        __atomic_load_n(&entries[offset], __ATOMIC_ACQUIRE);
+    if (entry != NULL) {
+      return entry;
+    }
+  }
+
+  mca_precision_map_entry_t *entry = _mca_map_resolve(function_info);
+
+  while (__atomic_test_and_set(&_mca_map_table_lock, __ATOMIC_ACQUIRE))
+    ;
+  if (_mca_map_table[chunk] == NULL) {
+    entries = calloc(_MCA_MAP_CHUNK_SIZE, sizeof(mca_precision_map_entry_t *));
+    if (entries == NULL) {
+      logger_error("cannot allocate the precision map table");
+    }
+    __atomic_store_n(&_mca_map_table[chunk], entries, __ATOMIC_RELEASE);
+  }
+  __atomic_store_n(&_mca_map_table[chunk][offset], entry, __ATOMIC_RELEASE);
+  __atomic_clear(&_mca_map_table_lock, __ATOMIC_RELEASE);
+
+  return entry;
+}
+
+/* Reads the precision map file. Each line holds a function name or a call
+ * site identifier, its binary64 precision and optionally its binary32
+ * precision. Empty lines and lines starting with # are ignored. */
+static void _mca_read_precision_map(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    logger_error("--%s: cannot open %s", key_precision_map_str, path);
+  }
+
+  _mca_precision_map = vfc_hashmap_create();
+
+  char line[4096], id[4096];
+  int lineno = 0;
+  while (fgets(line, sizeof(line), f) != NULL) {
+    lineno++;
+    const char *start = line + strspn(line, " \t");
+    if (*start == '#' || *start == '\n' || *start == '\0') {
+      continue;
+    }
+
+    int binary64 = 0, binary32 = 0;
+    const int n = sscanf(start, "%4095s %d %d", id, &binary64, &binary32);
+    if (n < 2) {
+      logger_error("%s:%d: expected <function or call site> "
+                   "<precision-binary64> [<precision-binary32>]",
+                   path, lineno);
+    }
+    if (binary64 < MCA_PRECISION_BINARY64_MIN ||
+        binary64 > MCA_PRECISION_BINARY64_MAX) {
+      logger_error("%s:%d: binary64 precision must be in [%d, %d]", path,
+                   lineno, MCA_PRECISION_BINARY64_MIN,
+                   MCA_PRECISION_BINARY64_MAX);
+    }
+    if (n == 3 && (binary32 < MCA_PRECISION_BINARY32_MIN ||
+                   binary32 > MCA_PRECISION_BINARY32_MAX)) {
+      logger_error("%s:%d: binary32 precision must be in [%d, %d]", path,
+                   lineno, MCA_PRECISION_BINARY32_MIN,
+                   MCA_PRECISION_BINARY32_MAX);
+    }
+    if (_mca_map_find(id) != NULL) {
+      logger_error("%s:%d: %s is already in the map", path, lineno, id);
+    }
+
+    mca_precision_map_entry_t *entry =
+        malloc(sizeof(mca_precision_map_entry_t));
+    entry->id = strdup(id);
+    entry->binary64 = binary64;
+    entry->binary32 = (n == 3) ? binary32 : 0;
+    vfc_hashmap_insert(_mca_precision_map, vfc_hashmap_str_function(id),
+                       entry);
+  }
+
+  fclose(f);
+}
+
+/* Sets the precisions of the mapped functions */
+static void _interflop_enter_function(interflop_function_stack_t *stack,
+                                      void *context,
+                                      __attribute__((unused)) int nb_args,
+                                      __attribute__((unused))
+                                      interflop_function_arg_t *args) {
+  mca_precision_map_entry_t *entry = _mca_map_get(stack->array[stack->top]);
+  if (entry == &_mca_map_none) {
+    return;
+  }
+  _mca_sync_state((t_context *)context);
+
+  if (_mca_map_stack_top + _MCA_MAP_FRAME_SIZE > _mca_map_stack_size) {
+    if (_mca_map_stack_size == 0) {
+      pthread_setspecific(_mca_map_stack_key, &_mca_map_stack);
+    }
+    _mca_map_stack_size = (_mca_map_stack_size == 0) ? 64
+                                                     : 2 * _mca_map_stack_size;
+    _mca_map_stack =
+        realloc(_mca_map_stack, _mca_map_stack_size * sizeof(int));
+    if (_mca_map_stack == NULL) {
+      logger_error("cannot allocate the precision map stack");
+    }
+  }
+  _mca_map_stack[_mca_map_stack_top++] = MCALIB_BINARY64_T;
+  _mca_map_stack[_mca_map_stack_top++] = MCALIB_BINARY32_T;
+  _mca_map_stack[_mca_map_stack_top++] = MCALIB_MAP_BINARY64_T;
+  _mca_map_stack[_mca_map_stack_top++] = MCALIB_MAP_BINARY32_T;
+
+  MCALIB_MAP_BINARY64_T = entry->binary64;
+  MCALIB_BINARY64_T = entry->binary64;
+  if (entry->binary32 > 0) {
+    MCALIB_MAP_BINARY32_T = entry->binary32;
+    MCALIB_BINARY32_T = entry->binary32;
+  }
+}
+
+/* Restores the precisions of the callers of the mapped functions */
+static void _interflop_exit_function(interflop_function_stack_t *stack,
+                                     void *context,
+                                     __attribute__((unused)) int nb_args,
+                                     __attribute__((unused))
+                                     interflop_function_arg_t *args) {
+  mca_precision_map_entry_t *entry = _mca_map_get(stack->array[stack->top]);
+  if (entry == &_mca_map_none || _mca_map_stack_top < _MCA_MAP_FRAME_SIZE) {
+    return;
+  }
+  const t_context *ctx = (t_context *)context;
+  _mca_sync_state(ctx);
+
+  MCALIB_MAP_BINARY32_T = _mca_map_stack[--_mca_map_stack_top];
+  MCALIB_MAP_BINARY64_T = _mca_map_stack[--_mca_map_stack_top];
+  MCALIB_BINARY32_T = _mca_map_stack[--_mca_map_stack_top];
+  MCALIB_BINARY64_T = _mca_map_stack[--_mca_map_stack_top];
+
+  /* the precisions saved are outdated when a user call has changed the ones
+   * of the context meanwhile, they are copied again on the next operation */
+  if (ctx->precision_scope == mca_precision_scope_process) {
+    MCALIB_GENERATION = 0;
+  }
+}
+
 static struct argp_option options[] = {
     {key_prec_b32_str, KEY_PREC_B32, "PRECISION", 0,
      "select precision for binary32 (PRECISION > 0)", 0},
@@ -463,6 +1264,18 @@ static struct argp_option options[] = {
      0},
     {key_sparsity_str, KEY_SPARSITY, "SPARSITY", 0,
      "one in {sparsity} operations will be perturbed. 0 < sparsity <= 1.", 0},
+    {key_quad_binary64_str, KEY_QUAD_BINARY64, 0, 0,
+     "compute binary64 operations with binary128 instead of double-double",
+     0},
+    {key_simd_str, KEY_SIMD, "SIMD", 0,
+     "select the vector kernels among {auto, none, avx2, avx512}", 0},
+    {key_precision_map_str, KEY_PRECISION_MAP, "FILE", 0,
+     "set the precisions of the functions and call sites listed in FILE",
+     0},
+    {key_precision_scope_str, KEY_PRECISION_SCOPE, "SCOPE", 0,
+     "select the scope of the precisions set by user calls among "
+     "{thread, process}",
+     0},
     {0}};
 
 error_t parse_opt(int key, char *arg, struct argp_state *state) {
@@ -478,7 +1291,7 @@ error_t parse_opt(int key, char *arg, struct argp_state *state) {
       logger_error("--%s invalid value provided, must be a positive integer",
                    key_prec_b32_str);
     } else {
-      _set_mca_precision_binary32(val);
+      _set_mca_precision_binary32(ctx, val);
     }
     break;
   case KEY_PREC_B64:
@@ -489,19 +1302,19 @@ error_t parse_opt(int key, char *arg, struct argp_state *state) {
       logger_error("--%s invalid value provided, must be a positive integer",
                    key_prec_b64_str);
     } else {
-      _set_mca_precision_binary64(val);
+      _set_mca_precision_binary64(ctx, val);
     }
     break;
   case KEY_MODE:
     /* mca mode */
     if (strcasecmp(MCA_MODE_STR[mcamode_ieee], arg) == 0) {
-      _set_mca_mode(mcamode_ieee);
+      _set_mca_mode(ctx, mcamode_ieee);
     } else if (strcasecmp(MCA_MODE_STR[mcamode_mca], arg) == 0) {
-      _set_mca_mode(mcamode_mca);
+      _set_mca_mode(ctx, mcamode_mca);
     } else if (strcasecmp(MCA_MODE_STR[mcamode_pb], arg) == 0) {
-      _set_mca_mode(mcamode_pb);
+      _set_mca_mode(ctx, mcamode_pb);
     } else if (strcasecmp(MCA_MODE_STR[mcamode_rr], arg) == 0) {
-      _set_mca_mode(mcamode_rr);
+      _set_mca_mode(ctx, mcamode_rr);
     } else {
       logger_error("--%s invalid value provided, must be one of: "
                    "{ieee, mca, pb, rr}.",
@@ -552,6 +1365,42 @@ error_t parse_opt(int key, char *arg, struct argp_state *state) {
     /* flush-to-zero */
     ctx->ftz = true;
     break;
+  case KEY_QUAD_BINARY64:
+    /* binary128 intermediate computations */
+    ctx->quad_binary64 = true;
+    break;
+  case KEY_SIMD:
+    /* vector kernels */
+    ctx->simd = _mca_simd_end_;
+    for (int i = 0; i < _mca_simd_end_; i++) {
+      if (strcasecmp(MCA_SIMD_STR[i], arg) == 0) {
+        ctx->simd = i;
+      }
+    }
+    if (ctx->simd == _mca_simd_end_) {
+      logger_error("--%s invalid value provided, must be one of: "
+                   "{auto, none, avx2, avx512}.",
+                   key_simd_str);
+    }
+    break;
+  case KEY_PRECISION_MAP:
+    /* per-function precisions */
+    ctx->precision_map = arg;
+    break;
+  case KEY_PRECISION_SCOPE:
+    /* scope of the precisions set by user calls */
+    ctx->precision_scope = _mca_precision_scope_end_;
+    for (int i = 0; i < _mca_precision_scope_end_; i++) {
+      if (strcasecmp(MCA_PRECISION_SCOPE_STR[i], arg) == 0) {
+        ctx->precision_scope = i;
+      }
+    }
+    if (ctx->precision_scope == _mca_precision_scope_end_) {
+      logger_error("--%s invalid value provided, must be one of: "
+                   "{thread, process}.",
+                   key_precision_scope_str);
+    }
+    break;
   case KEY_SPARSITY:
     /* sparse perturbations */
     errno = 0;
@@ -581,6 +1430,14 @@ void init_context(t_context *ctx) {
   ctx->ftz = false;
   ctx->seed = 0ULL;
   ctx->sparsity = 1.0f;
+  ctx->quad_binary64 = false;
+  ctx->simd = mca_simd_auto;
+  ctx->precision_map = NULL;
+  ctx->precision_scope = mca_precision_scope_thread;
+  ctx->mode = MCA_MODE_DEFAULT;
+  ctx->binary32_t = MCA_PRECISION_BINARY32_DEFAULT;
+  ctx->binary64_t = MCA_PRECISION_BINARY64_DEFAULT;
+  ctx->generation = 1;
 }
 
 void print_information_header(void *context) {
@@ -593,11 +1450,15 @@ void print_information_header(void *context) {
               "%s = %s, "
               "%s = %d, "
               "%s = %s, "
+              "%s = %s, "
+              "%s = %f, "
+              "%s = %s, "
+              "%s = %s, "
               "%s = %s and "
-              "%s = %f"
+              "%s = %s"
               "\n",
-              key_prec_b32_str, MCALIB_BINARY32_T, key_prec_b64_str,
-              MCALIB_BINARY64_T, key_mode_str, MCA_MODE_STR[MCALIB_MODE],
+              key_prec_b32_str, ctx->binary32_t, key_prec_b64_str,
+              ctx->binary64_t, key_mode_str, MCA_MODE_STR[ctx->mode],
               key_err_mode_str,
               (ctx->relErr && !ctx->absErr)
                   ? MCA_ERR_MODE_STR[mca_err_mode_rel]
@@ -608,7 +1469,12 @@ void print_information_header(void *context) {
                               : MCA_ERR_MODE_STR[mca_err_mode_rel],
               key_err_exp_str, (ctx->absErr_exp), key_daz_str,
               ctx->daz ? "true" : "false", key_ftz_str,
-              ctx->ftz ? "true" : "false", key_sparsity_str, ctx->sparsity);
+              ctx->ftz ? "true" : "false", key_sparsity_str, ctx->sparsity,
+              key_quad_binary64_str, ctx->quad_binary64 ? "true" : "false",
+              key_simd_str, MCA_SIMD_STR[ctx->simd], key_precision_map_str,
+              (ctx->precision_map != NULL) ? ctx->precision_map : "none",
+              key_precision_scope_str,
+              MCA_PRECISION_SCOPE_STR[ctx->precision_scope]);
 }
 
 struct interflop_backend_interface_t interflop_init(int argc, char **argv,
@@ -617,10 +1483,6 @@ struct interflop_backend_interface_t interflop_init(int argc, char **argv,
   /* Initialize the logger */
   logger_init();
 
-  _set_mca_precision_binary32(MCA_PRECISION_BINARY32_DEFAULT);
-  _set_mca_precision_binary64(MCA_PRECISION_BINARY64_DEFAULT);
-  _set_mca_mode(MCA_MODE_DEFAULT);
-
   t_context *ctx = malloc(sizeof(t_context));
   *context = ctx;
   init_context(ctx);
@@ -628,8 +1490,18 @@ struct interflop_backend_interface_t interflop_init(int argc, char **argv,
   /* Parse backend arguments */
   argp_parse(&argp, argc, argv, 0, 0, ctx);
 
+  ctx->simd = _set_mca_simd(ctx->simd);
+
   print_information_header(ctx);
 
+  /* the function hooks are only installed with a precision map */
+  if (ctx->precision_map != NULL) {
+    _mca_read_precision_map(ctx->precision_map);
+    if (pthread_key_create(&_mca_map_stack_key, _mca_map_stack_free) != 0) {
+      logger_error("cannot create the precision map stack key");
+    }
+  }
+
   struct interflop_backend_interface_t interflop_backend_mca = {
       _interflop_add_float,
       _interflop_sub_float,
@@ -641,15 +1513,23 @@ struct interflop_backend_interface_t interflop_init(int argc, char **argv,
       _interflop_mul_double,
       _interflop_div_double,
       NULL,
-      NULL,
-      NULL,
+      (_mca_precision_map != NULL) ? _interflop_enter_function : NULL,
+      (_mca_precision_map != NULL) ? _interflop_exit_function : NULL,
       _interflop_user_call,
-      NULL};
+      NULL,
+      _interflop_add_float_vector,
+      _interflop_sub_float_vector,
+      _interflop_mul_float_vector,
+      _interflop_div_float_vector,
+      _interflop_add_double_vector,
+      _interflop_sub_double_vector,
+      _interflop_mul_double_vector,
+      _interflop_div_double_vector};
 
   /* The seed for the RNG is initialized upon the first request for a random
      number */
 
-  _init_rng_state_struct(&rng_state, ctx->choose_seed, ctx->seed, false);
+  vfc_rng_set_seed(ctx->choose_seed, ctx->seed);
 
   return interflop_backend_mca;
 }
@@ -0,0 +1,203 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2022                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+// Template of the MCA vector kernels. It is included by interflop_mca.c once
+// per instruction set, with the macros described in common/mca_simd.h which
+// provides the lane helpers.
+//
+// The kernels follow the scalar functions of interflop_mca.c: binary32 lanes
+// are computed in binary64 and binary64 lanes in double-double. The lanes
+// which the double-double path cannot process are computed by
+// _mca_binary64_binary_op.
+
+#include "../../common/mca_simd.h"
+
+/* Adds the noise to the lanes of x selected by mask */
+_MCA_SIMD_INLINE _VD _MCA_SIMD(_mca_simd_inexact)(const _VD x, const int t,
+                                                  const _VI mask,
+                                                  _VRNG *rng) {
+  const _VI e = _MCA_SIMD(_mca_simd_exponent)(x) - (t - 1);
+  const _VD noised = x + _MCA_SIMD(_mca_simd_noise)(e, rng);
+  return _MCA_SIMD(_mca_simd_select)(mask, noised, x);
+}
+
+/******************** KERNELS ********************/
+
+/* Performs mca(a[i] op b[i]) for the size binary32 lanes */
+/* Intermediate computations are performed with binary64 */
+static __attribute__((target(MCA_SIMD_TARGET))) void
+_MCA_SIMD(_mca_binary32_vector)(const int size, const float *a,
+                                const float *b, float *c,
+                                const mca_operations op, void *context) {
+  const t_context *ctx = (t_context *)context;
+  const int t = MCALIB_BINARY32_T;
+  const uint64_t representable = (1ULL << (DOUBLE_PREC - t)) - 1;
+  const bool inbound = MCALIB_MODE == mcamode_pb || MCALIB_MODE == mcamode_mca;
+  const bool outbound =
+      MCALIB_MODE == mcamode_rr || MCALIB_MODE == mcamode_mca;
+
+  _VRNG rng;
+  memcpy(&rng.s0, _mca_simd_s0, sizeof(rng.s0));
+  memcpy(&rng.s1, _mca_simd_s1, sizeof(rng.s1));
+
+  for (int i = 0; i < size; i += MCA_SIMD_LANES) {
+    const int n = (size - i < MCA_SIMD_LANES) ? size - i : MCA_SIMD_LANES;
+    float la[MCA_SIMD_LANES], lb[MCA_SIMD_LANES], lc[MCA_SIMD_LANES];
+    for (int j = 0; j < MCA_SIMD_LANES; j++) {
+      la[j] = (j < n) ? a[i + j] : 1.0f;
+      lb[j] = (j < n) ? b[i + j] : 1.0f;
+    }
+
+    _VF fa, fb;
+    memcpy(&fa, la, sizeof(fa));
+    memcpy(&fb, lb, sizeof(fb));
+    _VD x = __builtin_convertvector(fa, _VD);
+    _VD y = __builtin_convertvector(fb, _VD);
+    _VD res = {0};
+
+    if (inbound) {
+      _VI mask = _MCA_SIMD(_mca_simd_is_noised)(x) &
+                 _MCA_SIMD(_mca_simd_sparse)(ctx->sparsity, &rng);
+      x = _MCA_SIMD(_mca_simd_inexact)(x, t, mask, &rng);
+      mask = _MCA_SIMD(_mca_simd_is_noised)(y) &
+             _MCA_SIMD(_mca_simd_sparse)(ctx->sparsity, &rng);
+      y = _MCA_SIMD(_mca_simd_inexact)(y, t, mask, &rng);
+    }
+
+    PERFORM_BIN_OP(op, res, x, y);
+
+    if (outbound) {
+      _VI mask = _MCA_SIMD(_mca_simd_is_noised)(res) &
+                 _MCA_SIMD(_mca_simd_sparse)(ctx->sparsity, &rng);
+      if (MCALIB_MODE == mcamode_rr) {
+        mask &=
+            ~_MCA_SIMD(_mca_simd_is_representable)(res, representable);
+      }
+      res = _MCA_SIMD(_mca_simd_inexact)(res, t, mask, &rng);
+    }
+
+    const _VF fc = __builtin_convertvector(res, _VF);
+    memcpy(lc, &fc, sizeof(fc));
+    memcpy(c + i, lc, n * sizeof(float));
+  }
+
+  memcpy(_mca_simd_s0, &rng.s0, sizeof(rng.s0));
+  memcpy(_mca_simd_s1, &rng.s1, sizeof(rng.s1));
+}
+
+/* Performs mca(a[i] op b[i]) for the size binary64 lanes */
+/* Intermediate computations are performed with double-double */
+static __attribute__((target(MCA_SIMD_TARGET))) void
+_MCA_SIMD(_mca_binary64_vector)(const int size, const double *a,
+                                const double *b, double *c,
+                                const mca_operations op, void *context) {
+  const t_context *ctx = (t_context *)context;
+  const int t = MCALIB_BINARY64_T;
+  const uint64_t representable = (1ULL << (DOUBLE_PREC - t)) - 1;
+  const bool inbound = MCALIB_MODE == mcamode_pb || MCALIB_MODE == mcamode_mca;
+  const bool outbound =
+      MCALIB_MODE == mcamode_rr || MCALIB_MODE == mcamode_mca;
+  const bool zero_sum = op == mca_add || op == mca_sub;
+
+  _VRNG rng;
+  memcpy(&rng.s0, _mca_simd_s0, sizeof(rng.s0));
+  memcpy(&rng.s1, _mca_simd_s1, sizeof(rng.s1));
+
+  for (int i = 0; i < size; i += MCA_SIMD_LANES) {
+    const int n = (size - i < MCA_SIMD_LANES) ? size - i : MCA_SIMD_LANES;
+    double la[MCA_SIMD_LANES], lb[MCA_SIMD_LANES], lc[MCA_SIMD_LANES];
+    int64_t lvalid[MCA_SIMD_LANES];
+    for (int j = 0; j < MCA_SIMD_LANES; j++) {
+      la[j] = (j < n) ? a[i + j] : 1.0;
+      lb[j] = (j < n) ? b[i + j] : 1.0;
+    }
+
+    _VD va, vb, plain = {0};
+    memcpy(&va, la, sizeof(va));
+    memcpy(&vb, lb, sizeof(vb));
+
+    /* lanes accepted by _mca_dd_is_valid */
+    PERFORM_BIN_OP(op, plain, va, vb);
+    const _VI zero = plain == 0;
+    const _VI zero_valid = zero_sum ? ~(_VI){0} : (va == 0) | (vb == 0);
+    const _VI valid = _MCA_SIMD(_mca_simd_dd_in_range)(va) &
+                      _MCA_SIMD(_mca_simd_dd_in_range)(vb) &
+                      ((zero & zero_valid) |
+                       (~zero & _MCA_SIMD(_mca_simd_dd_in_range)(plain)));
+
+    _VDD x = {va, (_VD){0}};
+    _VDD y = {vb, (_VD){0}};
+    _VDD res = {(_VD){0}, (_VD){0}};
+
+    if (inbound) {
+      _VI mask = (va != 0) & _MCA_SIMD(_mca_simd_sparse)(ctx->sparsity, &rng);
+      x = _MCA_SIMD(_mca_simd_dd_inexact)(x, t, mask, &rng);
+      mask = (vb != 0) & _MCA_SIMD(_mca_simd_sparse)(ctx->sparsity, &rng);
+      y = _MCA_SIMD(_mca_simd_dd_inexact)(y, t, mask, &rng);
+    }
+
+    switch (op) {
+    case mca_add:
+      res = _MCA_SIMD(_mca_simd_dd_add)(x, y);
+      break;
+    case mca_sub:
+      res = _MCA_SIMD(_mca_simd_dd_add)(x, _MCA_SIMD(_mca_simd_dd_neg)(y));
+      break;
+    case mca_mul:
+      res = _MCA_SIMD(_mca_simd_dd_mul)(x, y);
+      break;
+    case mca_div:
+      res = _MCA_SIMD(_mca_simd_dd_div)(x, y);
+      break;
+    default:
+      logger_error("invalid operator %c", op);
+    }
+
+    /* the error-free transformations lose the sign of zero results */
+    _VD signed_zero = {0};
+    PERFORM_BIN_OP(op, signed_zero, x.hi, y.hi);
+    res.hi = _MCA_SIMD(_mca_simd_select)(res.hi == 0, signed_zero, res.hi);
+
+    if (outbound) {
+      _VI mask = (res.hi != 0) &
+                 _MCA_SIMD(_mca_simd_sparse)(ctx->sparsity, &rng);
+      if (MCALIB_MODE == mcamode_rr) {
+        mask &= ~((res.lo == 0) & _MCA_SIMD(_mca_simd_is_representable)(
+                                      res.hi, representable));
+      }
+      res = _MCA_SIMD(_mca_simd_dd_inexact)(res, t, mask, &rng);
+    }
+
+    memcpy(lc, &res.hi, sizeof(res.hi));
+    memcpy(lvalid, &valid, sizeof(valid));
+    for (int j = 0; j < n; j++) {
+      c[i + j] = (lvalid[j]) ? lc[j]
+                             : _mca_binary64_binary_op(a[i + j], b[i + j], op,
+                                                       context);
+    }
+  }
+
+  memcpy(_mca_simd_s0, &rng.s0, sizeof(rng.s0));
+  memcpy(_mca_simd_s1, &rng.s1, sizeof(rng.s1));
+}
+
+#undef _VRNG
+#undef _VDD
+#undef _VI32
+#undef _VF
+#undef _VI
+#undef _VU
+#undef _VD
+#undef _MCA_SIMD_INLINE
+#undef _MCA_SIMD
+#undef _MCA_SIMD_CAT
+#undef _MCA_SIMD_CAT2
@@ -0,0 +1,622 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2022                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+// The profile backend attributes time and floating-point operations to the
+// functions instrumented with --inst-func. It computes the IEEE result of
+// each operation, so it can be used alone or loaded before another backend
+// to find the functions that pay the most for the instrumentation.
+//
+// Each thread records its calls in a calling context tree, keyed by the
+// function descriptors. At the end of the execution, the backend writes a
+// flat report sorted by exclusive time, per call site and per called
+// function, and a folded stacks file which can be rendered with
+// flamegraph.pl.
+
+#include <argp.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILE_HAVE_TSC 1
+#else
+#define PROFILE_HAVE_TSC 0
+#endif
+
+#include "../../common/interflop.h"
+#include "../../common/logger.h"
+#include "../../common/vfc_hashmap.h"
+
+typedef enum {
+  KEY_OUTPUT_FILE = 'o',
+  KEY_FOLDED_FILE = 'f',
+  KEY_TIMER = 't',
+} key_args;
+
+static const char key_output_file_str[] = "output-file";
+static const char key_folded_file_str[] = "folded-file";
+static const char key_timer_str[] = "timer";
+
+typedef enum {
+  profile_timer_monotonic,
+  profile_timer_tsc,
+  _profile_timer_end_
+} profile_timer;
+
+static const char *PROFILE_TIMER_STR[] = {"monotonic", "tsc"};
+static const char *PROFILE_TIMER_UNIT[] = {"ns", "cycles"};
+
+#define PROFILE_OUTPUT_FILE_DEFAULT "vfc_profile.txt"
+#define PROFILE_FOLDED_FILE_DEFAULT "vfc_profile.folded"
+#define PROFILE_TIMER_DEFAULT profile_timer_monotonic
+
+typedef struct {
+  char *output_file;
+  char *folded_file;
+} t_context;
+
+static profile_timer PROFILE_TIMER = PROFILE_TIMER_DEFAULT;
+
+/* Node of the calling context tree of a thread */
+typedef struct _profile_node {
+  interflop_function_info_t *function;
+  struct _profile_node *parent;
+  struct _profile_node *children;
+  struct _profile_node *next;
+  uint64_t calls;
+  uint64_t inclusive;
+  uint64_t ops;
+  uint64_t start;
+} _profile_node_t;
+
+/* Calling context tree of a thread, the cursor is the node of the current
+ * function. Trees are chained so that they outlive their thread. */
+typedef struct _profile_thread {
+  _profile_node_t root;
+  _profile_node_t *cursor;
+  struct _profile_thread *next;
+} _profile_thread_t;
+
+static _profile_thread_t *_profile_threads = NULL;
+static char _profile_threads_lock = 0;
+
+static __thread _profile_thread_t *_profile_thread = NULL;
+
+/* Per called function statistics, summed over its call sites */
+typedef struct {
+  char *name;
+  uint64_t calls;
+  uint64_t inclusive;
+  uint64_t exclusive;
+  uint64_t ops;
+  /* number of nodes of this function on the path being visited, from any
+   * call site, used to count the inclusive time of recursive calls once */
+  uint64_t active;
+} _profile_callee_t;
+
+/* Per call site statistics, merged from the trees of all the threads */
+typedef struct {
+  interflop_function_info_t *function;
+  _profile_callee_t *callee;
+  uint64_t calls;
+  uint64_t inclusive;
+  uint64_t exclusive;
+  uint64_t ops;
+  /* number of nodes of this function on the path being visited, used to
+   * count the inclusive time of recursive calls once */
+  uint64_t active;
+} _profile_entry_t;
+
+/******************** TIMER ********************/
+
+static inline uint64_t _profile_now(void) {
+#if PROFILE_HAVE_TSC
+  if (PROFILE_TIMER == profile_timer_tsc)
+    return __rdtsc();
+#endif
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/******************** CALLING CONTEXT TREE ********************/
+
+/* Return the tree of the current thread, created on its first call */
+static _profile_thread_t *_profile_get_thread(void) {
+  if (_profile_thread != NULL)
+    return _profile_thread;
+
+  _profile_thread_t *thread = calloc(1, sizeof(_profile_thread_t));
+  if (thread == NULL)
+    logger_error("Cannot allocate the profile of a thread\n");
+
+  thread->cursor = &thread->root;
+
+  while (__atomic_test_and_set(&_profile_threads_lock, __ATOMIC_ACQUIRE))
+    ;
+  thread->next = _profile_threads;
+  _profile_threads = thread;
+  __atomic_clear(&_profile_threads_lock, __ATOMIC_RELEASE);
+
+  _profile_thread = thread;
+  return thread;
+}
+
+/* Return the child of node for function, created if needed */
+static _profile_node_t *_profile_child(_profile_node_t *node,
+                                       interflop_function_info_t *function) {
+  _profile_node_t *child;
+  for (child = node->children; child != NULL; child = child->next) {
+    if (child->function == function)
+      return child;
+  }
+
+  child = calloc(1, sizeof(_profile_node_t));
+  if (child == NULL)
+    logger_error("Cannot allocate a node of the profile\n");
+
+  child->function = function;
+  child->parent = node;
+  child->next = node->children;
+  node->children = child;
+  return child;
+}
+
+static void _profile_node_free(_profile_node_t *node) {
+  _profile_node_t *child = node->children;
+  while (child != NULL) {
+    _profile_node_t *next = child->next;
+    _profile_node_free(child);
+    free(child);
+    child = next;
+  }
+}
+
+/******************** HOOKS ********************/
+
+/* The operations are computed in IEEE and counted in the current function */
+#define _INTERFLOP_OP_CALL_PROFILE(TYPE, OP_NAME, OP)                          \
+  static void _interflop_##OP_NAME##_##TYPE(                                   \
+      TYPE a, TYPE b, TYPE *c, __attribute__((unused)) void *context) {        \
+    *c = a OP b;                                                               \
+    _profile_get_thread()->cursor->ops++;                                      \
+  }
+
+_INTERFLOP_OP_CALL_PROFILE(float, add, +)
+_INTERFLOP_OP_CALL_PROFILE(float, sub, -)
+_INTERFLOP_OP_CALL_PROFILE(float, mul, *)
+_INTERFLOP_OP_CALL_PROFILE(float, div, /)
+_INTERFLOP_OP_CALL_PROFILE(double, add, +)
+_INTERFLOP_OP_CALL_PROFILE(double, sub, -)
+_INTERFLOP_OP_CALL_PROFILE(double, mul, *)
+_INTERFLOP_OP_CALL_PROFILE(double, div, /)
+
+static void
+_interflop_enter_function(interflop_function_stack_t *stack,
+                          __attribute__((unused)) void *context,
+                          __attribute__((unused)) int nb_args,
+                          __attribute__((unused))
+                          interflop_function_arg_t *args) {
+  _profile_thread_t *thread = _profile_get_thread();
+  _profile_node_t *node =
+      _profile_child(thread->cursor, stack->array[stack->top]);
+
+  node->calls++;
+  thread->cursor = node;
+  /* read last so that the cost of the hook is not charged to the callee */
+  node->start = _profile_now();
+}
+
+static void
+_interflop_exit_function(__attribute__((unused))
+                         interflop_function_stack_t *stack,
+                         __attribute__((unused)) void *context,
+                         __attribute__((unused)) int nb_args,
+                         __attribute__((unused))
+                         interflop_function_arg_t *args) {
+  uint64_t now = _profile_now();
+  _profile_thread_t *thread = _profile_get_thread();
+  _profile_node_t *node = thread->cursor;
+
+  if (node->parent == NULL)
+    logger_error("Exit of a function which has not been entered\n");
+
+  node->inclusive += now - node->start;
+  thread->cursor = node->parent;
+}
+
+/******************** REPORTS ********************/
+
+/* Per call site statistics, indexed by the dense index of the descriptors */
+static _profile_entry_t *_profile_entries = NULL;
+static int _profile_entries_size = 0;
+
+/* Per called function statistics, keyed by the hash of their name */
+static vfc_hashmap_t _profile_callee_map = NULL;
+static _profile_callee_t **_profile_callees = NULL;
+static int _profile_callees_size = 0;
+static int _profile_callees_capacity = 0;
+
+/* Return the statistics of the function called by a call site, created if
+ * needed. Identifiers are file/caller/callee/line/n, where the file may
+ * contain slashes, the whole identifier is used if it has another form. */
+static _profile_callee_t *
+_profile_get_callee(interflop_function_info_t *function) {
+  const char *id = function->id;
+  const char *end = id + strlen(id);
+  const char *slash[3] = {NULL, NULL, NULL};
+  int found = 0;
+  for (const char *c = end - 1; c >= id && found < 3; c--) {
+    if (*c == '/')
+      slash[found++] = c;
+  }
+
+  const char *start = (found == 3) ? slash[2] + 1 : id;
+  size_t length = (found == 3) ? (size_t)(slash[1] - start) : strlen(id);
+  char *name = strndup(start, length);
+  if (name == NULL)
+    logger_error("Cannot allocate the profile report\n");
+
+  if (_profile_callee_map == NULL)
+    _profile_callee_map = vfc_hashmap_create();
+
+  size_t key = vfc_hashmap_str_function(name);
+  _profile_callee_t *callee = vfc_hashmap_get(_profile_callee_map, key);
+  if (callee != NULL && strcmp(callee->name, name) != 0) {
+    /* hash collision, fall back to a linear search */
+    callee = NULL;
+    for (int i = 0; i < _profile_callees_size && callee == NULL; i++) {
+      if (strcmp(_profile_callees[i]->name, name) == 0)
+        callee = _profile_callees[i];
+    }
+  }
+
+  if (callee != NULL) {
+    free(name);
+    return callee;
+  }
+
+  if (_profile_callees_size == _profile_callees_capacity) {
+    _profile_callees_capacity =
+        (_profile_callees_capacity == 0) ? 64 : 2 * _profile_callees_capacity;
+    _profile_callees =
+        realloc(_profile_callees,
+                _profile_callees_capacity * sizeof(_profile_callee_t *));
+    if (_profile_callees == NULL)
+      logger_error("Cannot allocate the profile report\n");
+  }
+
+  callee = calloc(1, sizeof(_profile_callee_t));
+  if (callee == NULL)
+    logger_error("Cannot allocate the profile report\n");
+  callee->name = name;
+  _profile_callees[_profile_callees_size++] = callee;
+  if (!vfc_hashmap_have(_profile_callee_map, key))
+    vfc_hashmap_insert(_profile_callee_map, key, callee);
+
+  return callee;
+}
+
+static _profile_entry_t *_profile_get_entry(
+    interflop_function_info_t *function) {
+  if (function->index < 0)
+    logger_error("Function %s has not been registered\n", function->id);
+
+  if (function->index >= _profile_entries_size) {
+    int size = (_profile_entries_size == 0) ? 64 : 2 * _profile_entries_size;
+    while (size <= function->index)
+      size *= 2;
+
+    _profile_entries =
+        realloc(_profile_entries, size * sizeof(_profile_entry_t));
+    if (_profile_entries == NULL)
+      logger_error("Cannot allocate the profile report\n");
+
+    memset(_profile_entries + _profile_entries_size, 0,
+           (size - _profile_entries_size) * sizeof(_profile_entry_t));
+    _profile_entries_size = size;
+  }
+
+  _profile_entry_t *entry = &_profile_entries[function->index];
+  if (entry->function == NULL) {
+    entry->function = function;
+    entry->callee = _profile_get_callee(function);
+  }
+  return entry;
+}
+
+/* Growable buffer holding the folded stack of the node being visited */
+static char *_profile_path = NULL;
+static size_t _profile_path_size = 0;
+
+static void _profile_path_reserve(size_t size) {
+  if (size <= _profile_path_size)
+    return;
+
+  size_t new_size = (_profile_path_size == 0) ? 1024 : 2 * _profile_path_size;
+  while (new_size < size)
+    new_size *= 2;
+
+  _profile_path = realloc(_profile_path, new_size);
+  if (_profile_path == NULL)
+    logger_error("Cannot allocate the folded stack buffer\n");
+
+  _profile_path_size = new_size;
+}
+
+/* Visit the subtree of node: merge it in the per call site and per called
+ * function statistics and write its folded stacks. length is the length of
+ * the path of node. */
+static void _profile_visit(_profile_node_t *node, size_t length,
+                           FILE *folded) {
+  uint64_t children = 0;
+  for (_profile_node_t *c = node->children; c != NULL; c = c->next)
+    children += c->inclusive;
+
+  uint64_t exclusive =
+      (node->inclusive > children) ? node->inclusive - children : 0;
+
+  _profile_entry_t *entry = _profile_get_entry(node->function);
+  entry->calls += node->calls;
+  entry->exclusive += exclusive;
+  entry->ops += node->ops;
+  if (entry->active == 0)
+    entry->inclusive += node->inclusive;
+
+  _profile_callee_t *callee = entry->callee;
+  callee->calls += node->calls;
+  callee->exclusive += exclusive;
+  callee->ops += node->ops;
+  if (callee->active == 0)
+    callee->inclusive += node->inclusive;
+
+  size_t id_length = strlen(node->function->id);
+  _profile_path_reserve(length + id_length + 2);
+  if (length > 0)
+    _profile_path[length++] = ';';
+  memcpy(_profile_path + length, node->function->id, id_length + 1);
+  length += id_length;
+
+  if (folded != NULL && exclusive > 0)
+    fprintf(folded, "%s %" PRIu64 "\n", _profile_path, exclusive);
+
+  entry->active++;
+  callee->active++;
+  for (_profile_node_t *c = node->children; c != NULL; c = c->next)
+    _profile_visit(c, length, folded);
+  callee->active--;
+  entry->active--;
+}
+
+/* Sort by decreasing exclusive time */
+static int _profile_entry_cmp(const void *a, const void *b) {
+  const _profile_entry_t *x = a, *y = b;
+  if (x->exclusive != y->exclusive)
+    return (x->exclusive < y->exclusive) ? 1 : -1;
+  return x->function->index - y->function->index;
+}
+
+/* Sort by decreasing exclusive time */
+static int _profile_callee_cmp(const void *a, const void *b) {
+  const _profile_callee_t *x = *(_profile_callee_t *const *)a;
+  const _profile_callee_t *y = *(_profile_callee_t *const *)b;
+  if (x->exclusive != y->exclusive)
+    return (x->exclusive < y->exclusive) ? 1 : -1;
+  return strcmp(x->name, y->name);
+}
+
+static void _profile_write_report(t_context *ctx) {
+  FILE *folded = NULL;
+  if (ctx->folded_file != NULL) {
+    folded = fopen(ctx->folded_file, "w");
+    if (folded == NULL)
+      logger_error("Cannot open %s: %s\n", ctx->folded_file,
+                   strerror(errno));
+  }
+
+  uint64_t outside = 0;
+  for (_profile_thread_t *t = _profile_threads; t != NULL; t = t->next) {
+    outside += t->root.ops;
+    for (_profile_node_t *c = t->root.children; c != NULL; c = c->next)
+      _profile_visit(c, 0, folded);
+  }
+
+  if (folded != NULL)
+    fclose(folded);
+
+  /* compact the called functions and sort them */
+  int n = 0;
+  for (int i = 0; i < _profile_entries_size; i++) {
+    if (_profile_entries[i].function != NULL)
+      _profile_entries[n++] = _profile_entries[i];
+  }
+  qsort(_profile_entries, n, sizeof(_profile_entry_t), _profile_entry_cmp);
+  qsort(_profile_callees, _profile_callees_size, sizeof(_profile_callee_t *),
+        _profile_callee_cmp);
+
+  FILE *output = fopen(ctx->output_file, "w");
+  if (output == NULL)
+    logger_error("Cannot open %s: %s\n", ctx->output_file, strerror(errno));
+
+  fprintf(output, "# time unit: %s\n", PROFILE_TIMER_UNIT[PROFILE_TIMER]);
+  fprintf(output,
+          "# operations outside instrumented functions: %" PRIu64 "\n",
+          outside);
+  fprintf(output, "# per call site\n");
+  fprintf(output, "#exclusive\tinclusive\tcalls\tops\tops/call\tfunction\n");
+  for (int i = 0; i < n; i++) {
+    _profile_entry_t *e = &_profile_entries[i];
+    fprintf(output,
+            "%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%.1f\t%s\n",
+            e->exclusive,
+            e->inclusive, e->calls, e->ops,
+            (e->calls > 0) ? (double)e->ops / e->calls : 0.0, e->function->id);
+  }
+
+  fprintf(output, "# per called function, summed over its call sites\n");
+  fprintf(output, "#exclusive\tinclusive\tcalls\tops\tops/call\tfunction\n");
+  for (int i = 0; i < _profile_callees_size; i++) {
+    _profile_callee_t *e = _profile_callees[i];
+    fprintf(output,
+            "%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%.1f\t%s\n",
+            e->exclusive, e->inclusive, e->calls, e->ops,
+            (e->calls > 0) ? (double)e->ops / e->calls : 0.0, e->name);
+  }
+
+  fclose(output);
+}
+
+static void _interflop_finalize(void *context) {
+  t_context *ctx = (t_context *)context;
+
+  _profile_write_report(ctx);
+
+  _profile_thread_t *t = _profile_threads;
+  while (t != NULL) {
+    _profile_thread_t *next = t->next;
+    _profile_node_free(&t->root);
+    free(t);
+    t = next;
+  }
+  _profile_threads = NULL;
+  _profile_thread = NULL;
+
+  free(_profile_entries);
+  _profile_entries = NULL;
+  _profile_entries_size = 0;
+
+  for (int i = 0; i < _profile_callees_size; i++) {
+    free(_profile_callees[i]->name);
+    free(_profile_callees[i]);
+  }
+  free(_profile_callees);
+  _profile_callees = NULL;
+  _profile_callees_size = 0;
+  _profile_callees_capacity = 0;
+  if (_profile_callee_map != NULL) {
+    vfc_hashmap_destroy(_profile_callee_map);
+    _profile_callee_map = NULL;
+  }
+  free(_profile_path);
+  _profile_path = NULL;
+  _profile_path_size = 0;
+}
+
+/******************** OPTIONS ********************/
+
+static struct argp_option options[] = {
+    {key_output_file_str, KEY_OUTPUT_FILE, "OUTPUT", 0,
+     "output file of the per function report (default "
+     PROFILE_OUTPUT_FILE_DEFAULT ")",
+     0},
+    {key_folded_file_str, KEY_FOLDED_FILE, "FOLDED", 0,
+     "output file of the folded stacks for flamegraph.pl (default "
+     PROFILE_FOLDED_FILE_DEFAULT ")",
+     0},
+    {key_timer_str, KEY_TIMER, "TIMER", 0,
+     "select the timer {monotonic,tsc} (default monotonic)", 0},
+    {0}};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state) {
+  t_context *ctx = (t_context *)state->input;
+  switch (key) {
+  case KEY_OUTPUT_FILE:
+    ctx->output_file = strdup(arg);
+    break;
+  case KEY_FOLDED_FILE:
+    ctx->folded_file = strdup(arg);
+    break;
+  case KEY_TIMER:
+    if (strcasecmp(PROFILE_TIMER_STR[profile_timer_monotonic], arg) == 0) {
+      PROFILE_TIMER = profile_timer_monotonic;
+    } else if (strcasecmp(PROFILE_TIMER_STR[profile_timer_tsc], arg) == 0) {
+      if (!PROFILE_HAVE_TSC)
+        logger_error("--%s: tsc is not available on this architecture\n",
+                     key_timer_str);
+      PROFILE_TIMER = profile_timer_tsc;
+    } else {
+      logger_error("--%s invalid value provided, must be one of: "
+                   "{monotonic, tsc}.\n",
+                   key_timer_str);
+    }
+    break;
+  default:
+    return ARGP_ERR_UNKNOWN;
+  }
+  return 0;
+}
+
+static struct argp argp = {options, parse_opt, "", "", NULL, NULL, NULL};
+
+static void init_context(t_context *ctx) {
+  ctx->output_file = PROFILE_OUTPUT_FILE_DEFAULT;
+  ctx->folded_file = PROFILE_FOLDED_FILE_DEFAULT;
+}
+
+static void print_information_header(void *context) {
+  t_context *ctx = (t_context *)context;
+
+  logger_info("load backend with: ");
+  logger_info("%s = %s, %s = %s and %s = %s\n", key_output_file_str,
+              ctx->output_file, key_folded_file_str, ctx->folded_file,
+              key_timer_str, PROFILE_TIMER_STR[PROFILE_TIMER]);
+}
+
+struct interflop_backend_interface_t interflop_init(int argc, char **argv,
+                                                    void **context) {
+
+  logger_init();
+
+  PROFILE_TIMER = PROFILE_TIMER_DEFAULT;
+
+  t_context *ctx = malloc(sizeof(t_context));
+  *context = ctx;
+  init_context(ctx);
+
+  /* parse backend arguments */
+  argp_parse(&argp, argc, argv, 0, 0, ctx);
+
+  print_information_header(ctx);
+
+  struct interflop_backend_interface_t interflop_backend_profile = {
+      _interflop_add_float,
+      _interflop_sub_float,
+      _interflop_mul_float,
+      _interflop_div_float,
+      NULL,
+      _interflop_add_double,
+      _interflop_sub_double,
+      _interflop_mul_double,
+      _interflop_div_double,
+      NULL,
+      _interflop_enter_function,
+      _interflop_exit_function,
+      NULL,
+      _interflop_finalize,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL};
+
+  return interflop_backend_profile;
+}
@@ -29,6 +29,7 @@
 #include <err.h>
 #include <limits.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -41,6 +42,7 @@
 #include "../../common/float_utils.h"
 #include "../../common/interflop.h"
 #include "../../common/logger.h"
+#include "../../common/rng/vfc_rng.h"
 #include "../../common/vfc_hashmap.h"
 #include "../../common/vprec_tools.h"
 
@@ -54,6 +56,10 @@ typedef enum {
   KEY_OUTPUT_FILE,
   KEY_LOG_FILE,
   KEY_PRESET,
+  KEY_CCT_DEPTH,
+  KEY_SAMPLE_CALLS,
+  KEY_SAMPLE_ELEMENTS,
+  KEY_MAX_SAMPLE_ELEMENTS,
   KEY_MODE = 'm',
   KEY_ERR_MODE = 'e',
   KEY_INSTRUMENT = 'i',
@@ -75,6 +81,10 @@ static const char key_err_exp_str[] = "max-abs-error-exponent";
 static const char key_instrument_str[] = "instrument";
 static const char key_daz_str[] = "daz";
 static const char key_ftz_str[] = "ftz";
+static const char key_cct_depth_str[] = "cct-depth";
+static const char key_sample_calls_str[] = "sample-calls";
+static const char key_sample_elements_str[] = "sample-elements";
+static const char key_max_sample_elements_str[] = "max-sample-elements";
 
 typedef struct {
   bool relErr;
@@ -171,10 +181,43 @@ static const char *VPREC_PRESET_STR[] = {"binary16", "binary32",    "binary64",
 
 /* variables that control precision, range and mode */
 static vprec_mode VPRECLIB_MODE = VPREC_MODE_DEFAULT;
+/* precisions and ranges set by the options and the user calls */
 static int VPRECLIB_BINARY32_PRECISION = VPREC_PRECISION_BINARY32_DEFAULT;
 static int VPRECLIB_BINARY64_PRECISION = VPREC_PRECISION_BINARY64_DEFAULT;
 static int VPRECLIB_BINARY32_RANGE = VPREC_RANGE_BINARY32_DEFAULT;
 static int VPRECLIB_BINARY64_RANGE = VPREC_RANGE_BINARY64_DEFAULT;
+/* incremented each time one of the precisions or ranges above is set */
+static unsigned int VPRECLIB_GENERATION = 1;
+
+/* precisions and ranges used by the operations of a thread */
+typedef struct {
+  int binary32_precision;
+  int binary32_range;
+  int binary64_precision;
+  int binary64_range;
+  /* generation of the values copied, 0 until the first copy */
+  unsigned int generation;
+} vprec_precision_t;
+
+/* precisions of the current thread, they are copied from the values set */
+/* by the options and the user calls, then overridden by the ones of the */
+/* instrumented function being run, if any */
+static __thread vprec_precision_t vprec_thread_precision = {0};
+
+/* precisions of the operations of an instrumented function */
+typedef struct {
+  /* false when the function keeps the precisions of its caller */
+  bool set;
+  int binary32_precision;
+  int binary32_range;
+  int binary64_precision;
+  int binary64_range;
+} vprec_override_t;
+
+/* precisions of the instrumented function run by the current thread, they */
+/* are kept apart so that they survive a copy of the values set by the */
+/* options and the user calls */
+static __thread vprec_override_t vprec_thread_override = {0};
 
 static float _vprec_binary32_binary_op(float a, float b,
                                        const vprec_operation op, void *context);
@@ -200,7 +243,20 @@ static const char *vprec_input_file = NULL;
 static const char *vprec_output_file = NULL;
 static FILE *vprec_log_file = NULL;
 static vprec_inst_mode VPREC_INST_MODE = VPREC_INST_MODE_DEFAULT;
-static size_t vprec_log_depth = 0;
+/* indentation of the log of the current thread */
+static __thread size_t vprec_log_depth = 0;
+/* number of call sites of the calling contexts, 0 for flat function records */
+static int vprec_cct_depth = 0;
+/* arguments are recorded on one call out of vprec_sample_calls */
+static unsigned int vprec_sample_calls = 1;
+/* probability of recording an element of a pointer argument */
+static double vprec_sample_elements = 1.0;
+/* maximum number of recorded elements per pointer argument, 0 for no limit */
+static unsigned int vprec_max_sample_elements = 0;
+
+/* random number generator used to skip elements of pointer arguments */
+static pid_t vprec_global_tid = 0;
+static __thread rng_state_t vprec_rng_state;
 
 /* instrumentation modes' names */
 static const char *VPREC_INST_MODE_STR[] = {"arguments", "operations", "all",
@@ -230,7 +286,9 @@ void _set_vprec_precision_binary32(int precision) {
                  "must be lower than (%d)",
                  VPREC_RANGE_BINARY32_MAX);
   } else {
-    VPRECLIB_BINARY32_PRECISION = precision;
+    __atomic_store_n(&VPRECLIB_BINARY32_PRECISION, precision,
+                     __ATOMIC_RELAXED);
+    __atomic_add_fetch(&VPRECLIB_GENERATION, 1, __ATOMIC_RELEASE);
   }
 }
 
@@ -244,7 +302,8 @@ void _set_vprec_range_binary32(int range) {
                  "must be lower than (%d)",
                  VPREC_RANGE_BINARY32_MAX);
   } else {
-    VPRECLIB_BINARY32_RANGE = range;
+    __atomic_store_n(&VPRECLIB_BINARY32_RANGE, range, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&VPRECLIB_GENERATION, 1, __ATOMIC_RELEASE);
   }
 }
 
@@ -258,7 +317,9 @@ void _set_vprec_precision_binary64(int precision) {
                  "must be lower than (%d)",
                  VPREC_RANGE_BINARY64_MAX);
   } else {
-    VPRECLIB_BINARY64_PRECISION = precision;
+    __atomic_store_n(&VPRECLIB_BINARY64_PRECISION, precision,
+                     __ATOMIC_RELAXED);
+    __atomic_add_fetch(&VPRECLIB_GENERATION, 1, __ATOMIC_RELEASE);
   }
 }
 
@@ -272,8 +333,36 @@ void _set_vprec_range_binary64(int range) {
                  "must be lower than (%d)",
                  VPREC_RANGE_BINARY64_MAX);
   } else {
-    VPRECLIB_BINARY64_RANGE = range;
+    __atomic_store_n(&VPRECLIB_BINARY64_RANGE, range, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&VPRECLIB_GENERATION, 1, __ATOMIC_RELEASE);
+  }
+}
+
+/* Returns the precisions of the current thread, they are copied again */
+/* when the values set by the options and the user calls have changed, */
+/* and overridden by the ones of the instrumented function being run */
+static inline vprec_precision_t *_vprec_get_thread_precision(void) {
+  vprec_precision_t *prec = &vprec_thread_precision;
+  const unsigned int generation =
+      __atomic_load_n(&VPRECLIB_GENERATION, __ATOMIC_ACQUIRE);
+  if (prec->generation != generation) {
+    prec->binary32_precision =
+        __atomic_load_n(&VPRECLIB_BINARY32_PRECISION, __ATOMIC_RELAXED);
+    prec->binary32_range =
+        __atomic_load_n(&VPRECLIB_BINARY32_RANGE, __ATOMIC_RELAXED);
+    prec->binary64_precision =
+        __atomic_load_n(&VPRECLIB_BINARY64_PRECISION, __ATOMIC_RELAXED);
+    prec->binary64_range =
+        __atomic_load_n(&VPRECLIB_BINARY64_RANGE, __ATOMIC_RELAXED);
+    if (vprec_thread_override.set) {
+      prec->binary32_precision = vprec_thread_override.binary32_precision;
+      prec->binary32_range = vprec_thread_override.binary32_range;
+      prec->binary64_precision = vprec_thread_override.binary64_precision;
+      prec->binary64_range = vprec_thread_override.binary64_range;
+    }
+    prec->generation = generation;
   }
+  return prec;
 }
 
 void _set_vprec_input_file(const char *input_file) {
@@ -301,6 +390,41 @@ void _set_vprec_inst_mode(vprec_inst_mode mode) {
   }
 }
 
+void _set_vprec_cct_depth(int depth) {
+  if (depth < 0) {
+    logger_error("invalid calling context depth provided, must be a positive "
+                 "integer.");
+  } else {
+    vprec_cct_depth = depth;
+  }
+}
+
+void _set_vprec_sample_calls(int calls) {
+  if (calls < 1) {
+    logger_error("invalid number of calls provided, must be a strictly "
+                 "positive integer.");
+  } else {
+    vprec_sample_calls = calls;
+  }
+}
+
+void _set_vprec_sample_elements(double rate) {
+  if (!(0 < rate && rate <= 1)) {
+    logger_error("invalid sampling rate provided, must be in (0, 1].");
+  } else {
+    vprec_sample_elements = rate;
+  }
+}
+
+void _set_vprec_max_sample_elements(int elements) {
+  if (elements < 0) {
+    logger_error("invalid number of elements provided, must be a positive "
+                 "integer.");
+  } else {
+    vprec_max_sample_elements = elements;
+  }
+}
+
 /******************** VPREC HELPER FUNCTIONS *******************
  * The following functions are used to set virtual precision,
  * VPREC mode of operation and instrumentation mode.
@@ -586,19 +710,20 @@ static inline float _vprec_binary32_binary_op(float a, float b,
                                               const vprec_operation op,
                                               void *context) {
   float res = 0;
+  const vprec_precision_t *prec = _vprec_get_thread_precision();
 
   if ((VPRECLIB_MODE == vprecmode_full) || (VPRECLIB_MODE == vprecmode_ib)) {
-    a = _vprec_round_binary32(a, 1, context, VPRECLIB_BINARY32_RANGE,
-                              VPRECLIB_BINARY32_PRECISION);
-    b = _vprec_round_binary32(b, 1, context, VPRECLIB_BINARY32_RANGE,
-                              VPRECLIB_BINARY32_PRECISION);
+    a = _vprec_round_binary32(a, 1, context, prec->binary32_range,
+                              prec->binary32_precision);
+    b = _vprec_round_binary32(b, 1, context, prec->binary32_range,
+                              prec->binary32_precision);
   }
 
   perform_binary_op(op, res, a, b);
 
   if ((VPRECLIB_MODE == vprecmode_full) || (VPRECLIB_MODE == vprecmode_ob)) {
-    res = _vprec_round_binary32(res, 0, context, VPRECLIB_BINARY32_RANGE,
-                                VPRECLIB_BINARY32_PRECISION);
+    res = _vprec_round_binary32(res, 0, context, prec->binary32_range,
+                                prec->binary32_precision);
   }
 
   return res;
@@ -608,19 +733,20 @@ static inline double _vprec_binary64_binary_op(double a, double b,
                                                const vprec_operation op,
                                                void *context) {
   double res = 0;
+  const vprec_precision_t *prec = _vprec_get_thread_precision();
 
   if ((VPRECLIB_MODE == vprecmode_full) || (VPRECLIB_MODE == vprecmode_ib)) {
-    a = _vprec_round_binary64(a, 1, context, VPRECLIB_BINARY64_RANGE,
-                              VPRECLIB_BINARY64_PRECISION);
-    b = _vprec_round_binary64(b, 1, context, VPRECLIB_BINARY64_RANGE,
-                              VPRECLIB_BINARY64_PRECISION);
+    a = _vprec_round_binary64(a, 1, context, prec->binary64_range,
+                              prec->binary64_precision);
+    b = _vprec_round_binary64(b, 1, context, prec->binary64_range,
+                              prec->binary64_precision);
   }
 
   perform_binary_op(op, res, a, b);
 
   if ((VPRECLIB_MODE == vprecmode_full) || (VPRECLIB_MODE == vprecmode_ob)) {
-    res = _vprec_round_binary64(res, 0, context, VPRECLIB_BINARY64_RANGE,
-                                VPRECLIB_BINARY64_PRECISION);
+    res = _vprec_round_binary64(res, 0, context, prec->binary64_range,
+                                prec->binary64_precision);
   }
 
   return res;
@@ -652,10 +778,16 @@ typedef struct _vprec_argument_data {
   int mantissa_length;
 } _vprec_argument_data_t;
 
+// Maximum size of the function ids
+#define VPREC_FUNCTION_ID_MAXSIZE 2048
+
+// Separator of the call sites in the path of a calling context
+#define VPREC_CCT_SEPARATOR '>'
+
 // Metadata of function calls
 typedef struct _vprec_inst_function {
-  // Id of the function
-  char id[500];
+  // Id of the function, or path of the calling context with --cct-depth
+  char id[VPREC_FUNCTION_ID_MAXSIZE];
   // Indicate if the function is from library
   short isLibraryFunction;
   // Indicate if the function is intrinsic
@@ -765,6 +897,20 @@ void _vprec_read_hasmap(FILE *fin) {
       }
     }
 
+    // the precisions of the operations are set without checks when the
+    // function is entered
+    if (function.OpsPrec64 < VPREC_PRECISION_BINARY64_MIN ||
+        function.OpsPrec64 > VPREC_PRECISION_BINARY64_MAX ||
+        function.OpsRange64 < VPREC_RANGE_BINARY64_MIN ||
+        function.OpsRange64 > VPREC_RANGE_BINARY64_MAX ||
+        function.OpsPrec32 < VPREC_PRECISION_BINARY32_MIN ||
+        function.OpsPrec32 > VPREC_PRECISION_BINARY32_MAX ||
+        function.OpsRange32 < VPREC_RANGE_BINARY32_MIN ||
+        function.OpsRange32 > VPREC_RANGE_BINARY32_MAX) {
+      logger_error("invalid precision or range provided for %s\n",
+                   function.id);
+    }
+
     // insert in the hashmap
     _vprec_inst_function_t *address = malloc(sizeof(_vprec_inst_function_t));
     (*address) = function;
@@ -773,34 +919,28 @@ void _vprec_read_hasmap(FILE *fin) {
   }
 }
 
-// Print str in vprec_lof_file with the correct offset
-#define _vprec_print_log(_vprec_depth, _vprec_str, ...)                        \
-  ({                                                                           \
-    if (vprec_log_file != NULL) {                                              \
-      for (size_t _vprec_d = 0; _vprec_d < _vprec_depth; _vprec_d++)           \
-        fprintf(vprec_log_file, "\t");                                         \
-      fprintf(vprec_log_file, _vprec_str, ##__VA_ARGS__);                      \
-    }                                                                          \
-  })
-
-// Set precision for internal operations and round input arguments for a given
-// function call
-void _interflop_enter_function(interflop_function_stack_t *stack, void *context,
-                               int nb_args, va_list ap) {
-  interflop_function_info_t *function_info = stack->array[stack->top];
-
-  if (function_info == NULL)
-    logger_error("Call stack error\n");
-
-  _vprec_inst_function_t *function_inst = vfc_hashmap_get(
-      _vprec_func_map, vfc_hashmap_str_function(function_info->id));
+// Records of the functions indexed by the dense index of their descriptor,
+// the hashmap is only searched the first time a function is seen. The table
+// is split in chunks which are never moved, so that threads can read it
+// while another one adds a record.
+#define _VPREC_FUNC_CHUNK_SIZE 1024
+#define _VPREC_FUNC_CHUNK_NUMBER 4096
+static _vprec_inst_function_t **_vprec_func_table[_VPREC_FUNC_CHUNK_NUMBER];
+static char _vprec_func_table_lock = 0;
+
+// Search the record of id in the hashmap, create it if it does not exist.
+// Must be called with the table lock held.
+static _vprec_inst_function_t *
+_vprec_find_function(const char *id, interflop_function_info_t *function_info) {
+  _vprec_inst_function_t *function_inst =
+      vfc_hashmap_get(_vprec_func_map, vfc_hashmap_str_function(id));
 
   // if the function is not in the hashtable
   if (function_inst == NULL) {
     function_inst = malloc(sizeof(_vprec_inst_function_t));
 
     // initialize the structure
-    strcpy(function_inst->id, function_info->id);
+    strcpy(function_inst->id, id);
     function_inst->isLibraryFunction = function_info->isLibraryFunction;
     function_inst->isIntrinsicFunction = function_info->isIntrinsicFunction;
     function_inst->useFloat = function_info->useFloat;
@@ -816,26 +956,399 @@ void _interflop_enter_function(interflop_function_stack_t *stack, void *context,
     function_inst->n_calls = 0;
 
     // insert the function in the hashmap
-    vfc_hashmap_insert(_vprec_func_map,
-                       vfc_hashmap_str_function(function_info->id),
+    vfc_hashmap_insert(_vprec_func_map, vfc_hashmap_str_function(id),
                        function_inst);
   }
 
-  // increment the number of calls
-  function_inst->n_calls++;
-
-  // set internal operations precision with custom values depending on the mode
-  if (!function_info->isLibraryFunction &&
-      !function_info->isIntrinsicFunction && VPREC_INST_MODE != vprecinst_arg &&
-      VPREC_INST_MODE != vprecinst_none) {
-    _set_vprec_precision_binary64(function_inst->OpsPrec64);
-    _set_vprec_range_binary64(function_inst->OpsRange64);
-    _set_vprec_precision_binary32(function_inst->OpsPrec32);
-    _set_vprec_range_binary32(function_inst->OpsRange32);
+  return function_inst;
+}
+
+// Get the record of a function, create it if it does not exist
+static _vprec_inst_function_t *
+_vprec_get_function(interflop_function_info_t *function_info) {
+  int index = function_info->index;
+  int chunk = index / _VPREC_FUNC_CHUNK_SIZE;
+  int offset = index % _VPREC_FUNC_CHUNK_SIZE;
+  // descriptors which were not registered are always searched by name
+  int indexed = (index >= 0 && chunk < _VPREC_FUNC_CHUNK_NUMBER);
+
+  if (indexed) {
+    _vprec_inst_function_t **records =
+        __atomic_load_n(&_vprec_func_table[chunk], __ATOMIC_ACQUIRE);
+    if (records != NULL) {
+      _vprec_inst_function_t *function_inst =
+          __atomic_load_n(&records[offset], __ATOMIC_ACQUIRE);
+      if (function_inst != NULL)
+        return function_inst;
+    }
+  }
+
+  while (__atomic_test_and_set(&_vprec_func_table_lock, __ATOMIC_ACQUIRE))
+    ;
+
+  _vprec_inst_function_t *function_inst =
+      _vprec_find_function(function_info->id, function_info);
+
+  if (indexed) {
+    if (_vprec_func_table[chunk] == NULL) {
+      _vprec_inst_function_t **records =
+          calloc(_VPREC_FUNC_CHUNK_SIZE, sizeof(_vprec_inst_function_t *));
+      if (records == NULL)
+        logger_error("Cannot allocate the function table\n");
+      __atomic_store_n(&_vprec_func_table[chunk], records, __ATOMIC_RELEASE);
+    }
+    __atomic_store_n(&_vprec_func_table[chunk][offset], function_inst,
+                     __ATOMIC_RELEASE);
   }
 
+  __atomic_clear(&_vprec_func_table_lock, __ATOMIC_RELEASE);
+
+  return function_inst;
+}
+
+// With --cct-depth=K, records are kept per calling context: the path of the
+// last K call sites of the call stack. Contexts are stored in a tree going
+// from the callee to its callers, the context of a call is found by walking
+// at most K nodes keyed by the call site descriptors, without hashing.
+typedef struct _vprec_cct_node {
+  // Call site of the node
+  interflop_function_info_t *function;
+  // Record of the context ending at this node, created on first use
+  _vprec_inst_function_t *record;
+  // Contexts extending this one with one more caller
+  struct _vprec_cct_node *children;
+  // Next sibling
+  struct _vprec_cct_node *next;
+} _vprec_cct_node_t;
+
+static _vprec_cct_node_t _vprec_cct_root = {NULL, NULL, NULL, NULL};
+
+// Key whose destructor frees the calling context cursor and the precision
+// stack of a thread when it exits
+static pthread_key_t _vprec_thread_key;
+static void _vprec_thread_free(void *unused);
+
+// Records of the contexts entered by the current thread, the top one is the
+// context of the current call
+static __thread _vprec_inst_function_t **_vprec_cct_cursor = NULL;
+static __thread int _vprec_cct_cursor_size = 0;
+static __thread int _vprec_cct_cursor_top = 0;
+
+// Get the child of node for a call site, create it if it does not exist
+static _vprec_cct_node_t *
+_vprec_cct_child(_vprec_cct_node_t *node, interflop_function_info_t *function) {
+  _vprec_cct_node_t *child;
+
+  for (child = __atomic_load_n(&node->children, __ATOMIC_ACQUIRE);
+       child != NULL; child = child->next)
+    if (child->function == function)
+      return child;
+
+  while (__atomic_test_and_set(&_vprec_func_table_lock, __ATOMIC_ACQUIRE))
+    ;
+
+  // another thread may have added it in the meantime
+  for (child = node->children; child != NULL; child = child->next)
+    if (child->function == function)
+      break;
+
+  if (child == NULL) {
+    child = malloc(sizeof(_vprec_cct_node_t));
+    if (child == NULL)
+      logger_error("Cannot allocate the calling context tree\n");
+    child->function = function;
+    child->record = NULL;
+    child->children = NULL;
+    child->next = node->children;
+    __atomic_store_n(&node->children, child, __ATOMIC_RELEASE);
+  }
+
+  __atomic_clear(&_vprec_func_table_lock, __ATOMIC_RELEASE);
+
+  return child;
+}
+
+// Get the record of the calling context of the current call
+static _vprec_inst_function_t *
+_vprec_cct_get_context(interflop_function_stack_t *stack) {
+  _vprec_cct_node_t *node = &_vprec_cct_root;
+  int depth = 0;
+
+  for (; depth < vprec_cct_depth && stack->array[stack->top + depth] != NULL;
+       depth++)
+    node = _vprec_cct_child(node, stack->array[stack->top + depth]);
+
+  _vprec_inst_function_t *record =
+      __atomic_load_n(&node->record, __ATOMIC_ACQUIRE);
+  if (record != NULL)
+    return record;
+
+  // path of the context, from the outermost caller to the callee
+  char id[VPREC_FUNCTION_ID_MAXSIZE];
+  size_t length = 0;
+  id[0] = '\0';
+  for (int i = depth - 1; i >= 0; i--) {
+    length += snprintf(id + length, sizeof(id) - length, "%s%c",
+                       stack->array[stack->top + i]->id,
+                       (i > 0) ? VPREC_CCT_SEPARATOR : '\0');
+    if (length >= sizeof(id))
+      logger_error("Calling context is too long: %s\n", id);
+  }
+
+  while (__atomic_test_and_set(&_vprec_func_table_lock, __ATOMIC_ACQUIRE))
+    ;
+
+  record = _vprec_find_function(id, stack->array[stack->top]);
+  __atomic_store_n(&node->record, record, __ATOMIC_RELEASE);
+
+  __atomic_clear(&_vprec_func_table_lock, __ATOMIC_RELEASE);
+
+  return record;
+}
+
+// Enter the calling context of the current call
+static _vprec_inst_function_t *
+_vprec_cct_enter(interflop_function_stack_t *stack) {
+  _vprec_inst_function_t *record = _vprec_cct_get_context(stack);
+
+  if (_vprec_cct_cursor_top == _vprec_cct_cursor_size) {
+    if (_vprec_cct_cursor_size == 0)
+      pthread_setspecific(_vprec_thread_key, &_vprec_cct_cursor);
+    _vprec_cct_cursor_size =
+        (_vprec_cct_cursor_size == 0) ? 64 : 2 * _vprec_cct_cursor_size;
+    _vprec_cct_cursor =
+        realloc(_vprec_cct_cursor,
+                _vprec_cct_cursor_size * sizeof(_vprec_inst_function_t *));
+    if (_vprec_cct_cursor == NULL)
+      logger_error("Cannot allocate the calling context cursor\n");
+  }
+
+  _vprec_cct_cursor[_vprec_cct_cursor_top++] = record;
+
+  return record;
+}
+
+// Leave the calling context of the current call and return its record
+static _vprec_inst_function_t *_vprec_cct_exit() {
+  if (_vprec_cct_cursor_top == 0)
+    logger_error("Calling context error\n");
+
+  return _vprec_cct_cursor[--_vprec_cct_cursor_top];
+}
+
+// Free the calling context tree
+static void _vprec_cct_free(_vprec_cct_node_t *node) {
+  _vprec_cct_node_t *child = node->children;
+  while (child != NULL) {
+    _vprec_cct_node_t *next = child->next;
+    _vprec_cct_free(child);
+    free(child);
+    child = next;
+  }
+  node->children = NULL;
+}
+
+/******************** ARGUMENTS SAMPLING ********************
+ * Recording the range of the arguments and logging them costs a
+ * pass over every element of pointer arguments. Profiling runs can
+ * record them on one call out of --sample-calls, on a random subset
+ * of the elements with --sample-elements and bound the number of
+ * recorded elements with --max-sample-elements.
+ *************************************************************/
+
+// Return true if the arguments of the call number n_call (from 1) of a
+// function are recorded
+static inline int _vprec_sample_call(unsigned int n_call) {
+  return vprec_sample_calls == 1 || (n_call - 1) % vprec_sample_calls == 0;
+}
+
+// Number of elements skipped before the next recorded one, geometrically
+// distributed so that each element is recorded with probability
+// vprec_sample_elements
+static inline unsigned int _vprec_sample_skip(void) {
+  if (vprec_sample_elements >= 1.0)
+    return 0;
+
+  double u = get_rand_double01(&vprec_rng_state, &vprec_global_tid);
+  double skip = floor(log(u) / log1p(-vprec_sample_elements));
+  return (skip < UINT_MAX) ? (unsigned int)skip : UINT_MAX;
+}
+
+// Index of the first recorded element of a pointer argument of size elements,
+// size if none is recorded. budget counts the elements left to record.
+static inline unsigned int _vprec_sample_first(int record, unsigned int size,
+                                               unsigned int *budget) {
+  *budget = vprec_max_sample_elements;
+  if (!record)
+    return size;
+
+  unsigned int skip = _vprec_sample_skip();
+  return (skip < size) ? skip : size;
+}
+
+// Index of the recorded element following the element j, size if none
+static inline unsigned int _vprec_sample_next(unsigned int j,
+                                              unsigned int size,
+                                              unsigned int *budget) {
+  if (*budget > 0 && --(*budget) == 0)
+    return size;
+
+  unsigned int skip = _vprec_sample_skip();
+  return (skip < size - j - 1) ? j + 1 + skip : size;
+}
+
+// Precisions of the callers of the instrumented functions entered by the
+// current thread, with the numbers of these calls. The top one is restored
+// when the current call exits.
+typedef struct {
+  vprec_override_t override;
+  unsigned int n_call;
+} vprec_stack_entry_t;
+
+static __thread vprec_stack_entry_t *_vprec_precision_stack = NULL;
+static __thread int _vprec_precision_stack_size = 0;
+static __thread int _vprec_precision_stack_top = 0;
+
+// Save the precisions of the current thread with the number n_call of the
+// call entered, and set the ones of the operations of function if it is not
+// NULL. The precisions are computed again on the next operation.
+static void _vprec_push_precision(const _vprec_inst_function_t *function,
+                                  unsigned int n_call) {
+  if (_vprec_precision_stack_top == _vprec_precision_stack_size) {
+    if (_vprec_precision_stack_size == 0)
+      pthread_setspecific(_vprec_thread_key, &_vprec_precision_stack);
+    _vprec_precision_stack_size = (_vprec_precision_stack_size == 0)
+                                      ? 64
+                                      : 2 * _vprec_precision_stack_size;
+    _vprec_precision_stack =
+        realloc(_vprec_precision_stack,
+                _vprec_precision_stack_size * sizeof(vprec_stack_entry_t));
+    if (_vprec_precision_stack == NULL)
+      logger_error("Cannot allocate the precision stack\n");
+  }
+
+  vprec_stack_entry_t *entry =
+      &_vprec_precision_stack[_vprec_precision_stack_top++];
+  entry->override = vprec_thread_override;
+  entry->n_call = n_call;
+
+  if (function != NULL) {
+    vprec_thread_override.set = true;
+    vprec_thread_override.binary64_precision = function->OpsPrec64;
+    vprec_thread_override.binary64_range = function->OpsRange64;
+    vprec_thread_override.binary32_precision = function->OpsPrec32;
+    vprec_thread_override.binary32_range = function->OpsRange32;
+    vprec_thread_precision.generation = 0;
+  }
+}
+
+// Restore the precisions of the current thread saved by the last push, and
+// return the number of the call which exits. The values set by the user
+// calls meanwhile are kept.
+static unsigned int _vprec_pop_precision(void) {
+  if (_vprec_precision_stack_top == 0)
+    logger_error("Precision stack error\n");
+
+  vprec_stack_entry_t *entry =
+      &_vprec_precision_stack[--_vprec_precision_stack_top];
+  vprec_thread_override = entry->override;
+  vprec_thread_precision.generation = 0;
+  return entry->n_call;
+}
+
+// Free the calling context cursor and the precision stack of the current
+// thread, called when a thread exits and on finalization for the main thread
+static void _vprec_thread_free(__attribute__((unused)) void *unused) {
+  free(_vprec_cct_cursor);
+  _vprec_cct_cursor = NULL;
+  _vprec_cct_cursor_size = 0;
+  _vprec_cct_cursor_top = 0;
+
+  free(_vprec_precision_stack);
+  _vprec_precision_stack = NULL;
+  _vprec_precision_stack_size = 0;
+  _vprec_precision_stack_top = 0;
+}
+
+// Create the records of the nb_args arguments of a function on its first
+// call. They are initialized under the table lock and published once ready,
+// so that the other threads never see them partially initialized. Return
+// true for the thread which created them.
+static bool _vprec_init_args(_vprec_argument_data_t **records, int *nb_records,
+                             int nb_args, interflop_function_arg_t *args) {
+  if (nb_args == 0 || __atomic_load_n(records, __ATOMIC_ACQUIRE) != NULL)
+    return false;
+
+  while (__atomic_test_and_set(&_vprec_func_table_lock, __ATOMIC_ACQUIRE))
+    ;
+
+  bool created = (*records == NULL);
+  if (created) {
+    _vprec_argument_data_t *data =
+        malloc(sizeof(_vprec_argument_data_t) * nb_args);
+    if (data == NULL)
+      logger_error("Cannot allocate the argument records\n");
+
+    for (int i = 0; i < nb_args; i++) {
+      int type = args[i].type;
+      data[i].data_type = type;
+      strcpy(data[i].arg_id, args[i].name);
+      data[i].exponent_length = (type == FDOUBLE || type == FDOUBLE_PTR)
+                                    ? VPREC_RANGE_BINARY64_DEFAULT
+                                    : VPREC_RANGE_BINARY32_DEFAULT;
+      data[i].mantissa_length = (type == FDOUBLE || type == FDOUBLE_PTR)
+                                    ? VPREC_PRECISION_BINARY64_DEFAULT
+                                    : VPREC_PRECISION_BINARY32_DEFAULT;
+      data[i].min_range = INT_MAX;
+      data[i].max_range = INT_MIN;
+    }
+
+    *nb_records = nb_args;
+    __atomic_store_n(records, data, __ATOMIC_RELEASE);
+  }
+
+  __atomic_clear(&_vprec_func_table_lock, __ATOMIC_RELEASE);
+  return created;
+}
+
+// Print str in vprec_lof_file with the correct offset
+#define _vprec_print_log(_vprec_depth, _vprec_str, ...)                        \
+  ({                                                                           \
+    if (vprec_log_file != NULL) {                                              \
+      for (size_t _vprec_d = 0; _vprec_d < _vprec_depth; _vprec_d++)           \
+        fprintf(vprec_log_file, "\t");                                         \
+      fprintf(vprec_log_file, _vprec_str, ##__VA_ARGS__);                      \
+    }                                                                          \
+  })
+
+// Set precision for internal operations and round input arguments for a given
+// function call
+void _interflop_enter_function(interflop_function_stack_t *stack, void *context,
+                               int nb_args, interflop_function_arg_t *args) {
+  interflop_function_info_t *function_info = stack->array[stack->top];
+
+  if (function_info == NULL)
+    logger_error("Call stack error\n");
+
+  _vprec_inst_function_t *function_inst =
+      (vprec_cct_depth > 0) ? _vprec_cct_enter(stack)
+                            : _vprec_get_function(function_info);
+
+  // increment the number of calls, other threads may call function meanwhile
+  unsigned int n_call =
+      __atomic_fetch_add(&function_inst->n_calls, 1, __ATOMIC_RELAXED) + 1;
+
+  // set internal operations precision with custom values depending on the
+  // mode, the precision of the caller is restored on exit
+  int ops_flag = !function_info->isLibraryFunction &&
+                 !function_info->isIntrinsicFunction &&
+                 VPREC_INST_MODE != vprecinst_arg &&
+                 VPREC_INST_MODE != vprecinst_none;
+  _vprec_push_precision(ops_flag ? function_inst : NULL, n_call);
+
   // treatment of arguments
-  int new_flag = (function_inst->input_args == NULL && nb_args > 0);
+  int new_flag = _vprec_init_args(&function_inst->input_args,
+                                  &function_inst->nb_input_args, nb_args, args);
 
   // print function info in log
   _vprec_print_log(vprec_log_depth, "\n");
@@ -844,13 +1357,6 @@ void _interflop_enter_function(interflop_function_stack_t *stack, void *context,
                    function_inst->OpsRange64, function_inst->OpsPrec32,
                    function_inst->OpsRange32);
 
-  // allocate memory for arguments
-  if (new_flag) {
-    function_inst->input_args =
-        malloc(sizeof(_vprec_argument_data_t) * nb_args);
-    function_inst->nb_input_args = nb_args;
-  }
-
   // boolean which indicates if arguments should be rounded or not depending on
   // modes
   int mode_flag =
@@ -859,39 +1365,35 @@ void _interflop_enter_function(interflop_function_stack_t *stack, void *context,
         (VPREC_INST_MODE == vprecinst_arg)) &&
        VPREC_INST_MODE != vprecinst_none);
 
+  // arguments are rounded on every call, their ranges and logs are only
+  // recorded on the sampled calls
+  int round_flag = (!new_flag) && mode_flag;
+  int record_flag = new_flag || _vprec_sample_call(n_call);
+
   for (int i = 0; i < nb_args; i++) {
     // get argument type, id and size
-    int type = va_arg(ap, int);
-    char *arg_id = va_arg(ap, char *);
-    unsigned int size = va_arg(ap, unsigned int);
-
-    if (new_flag) {
-      function_inst->input_args[i].data_type = type;
-      strcpy(function_inst->input_args[i].arg_id, arg_id);
-      function_inst->input_args[i].min_range = INT_MAX;
-      function_inst->input_args[i].max_range = INT_MIN;
-      function_inst->input_args[i].exponent_length =
-          (type == FDOUBLE || type == FDOUBLE_PTR)
-              ? VPREC_RANGE_BINARY64_DEFAULT
-              : VPREC_RANGE_BINARY32_DEFAULT;
-      function_inst->input_args[i].mantissa_length =
-          (type == FDOUBLE || type == FDOUBLE_PTR)
-              ? VPREC_PRECISION_BINARY64_DEFAULT
-              : VPREC_PRECISION_BINARY32_DEFAULT;
-    }
+    int type = args[i].type;
+    const char *arg_id = args[i].name;
+    unsigned int size = args[i].size;
 
     if (type == FDOUBLE) {
-      double *value = va_arg(ap, double *);
+      double *value = (double *)args[i].value;
 
-      _vprec_print_log(vprec_log_depth, " - %s\tinput\tdouble\t%s\t%la\t->\t",
-                       function_inst->id, arg_id, *value);
+      if (record_flag) {
+        _vprec_print_log(vprec_log_depth,
+                         " - %s\tinput\tdouble\t%s\t%la\t->\t",
+                         function_inst->id, arg_id, *value);
+      }
 
-      if ((!new_flag) && mode_flag) {
+      if (round_flag) {
         *value = _vprec_round_binary64(
             *value, 1, context, function_inst->input_args[i].exponent_length,
             function_inst->input_args[i].mantissa_length);
       }
 
+      if (!record_flag)
+        continue;
+
       if (!(isnan(*value) || isinf(*value))) {
         function_inst->input_args[i].min_range =
             (floor(*value) < function_inst->input_args[i].min_range || new_flag)
@@ -908,17 +1410,23 @@ void _interflop_enter_function(interflop_function_stack_t *stack, void *context,
                        function_inst->input_args[i].exponent_length);
 
     } else if (type == FFLOAT) {
-      float *value = va_arg(ap, float *);
+      float *value = (float *)args[i].value;
 
-      _vprec_print_log(vprec_log_depth, " - %s\tinput\tfloat\t%s\t%a\t->\t",
-                       function_inst->id, arg_id, *value);
+      if (record_flag) {
+        _vprec_print_log(vprec_log_depth,
+                         " - %s\tinput\tfloat\t%s\t%a\t->\t",
+                         function_inst->id, arg_id, *value);
+      }
 
-      if ((!new_flag) && mode_flag) {
+      if (round_flag) {
         *value = _vprec_round_binary32(
             *value, 1, context, function_inst->input_args[i].exponent_length,
             function_inst->input_args[i].mantissa_length);
       }
 
+      if (!record_flag)
+        continue;
+
       if (!(isnan(*value) || isinf(*value))) {
         function_inst->input_args[i].min_range =
             (floorf(*value) < function_inst->input_args[i].min_range ||
@@ -936,80 +1444,110 @@ void _interflop_enter_function(interflop_function_stack_t *stack, void *context,
                        function_inst->input_args[i].exponent_length);
 
     } else if (type == FDOUBLE_PTR) {
-      double *value = va_arg(ap, double *);
+      double *value = (double *)args[i].value;
+
+      if (value == NULL) {
+        _vprec_print_log(vprec_log_depth,
+                         " - %s\tinput[0]\tdouble_ptr\t%s\tNULL\t->\tNULL\n",
+                         function_inst->id, arg_id);
+        continue;
+      }
+
+      // every element is visited when arguments are rounded, only the sampled
+      // ones otherwise
+      unsigned int budget;
+      unsigned int sample = _vprec_sample_first(record_flag, size, &budget);
+      for (unsigned int j = round_flag ? 0 : sample; j < size;
+           j = round_flag ? j + 1 : sample) {
+        int sampled = (j == sample);
 
-      for (unsigned int j = 0; j < size; j++, value++) {
-        if (value == NULL) {
+        if (sampled) {
           _vprec_print_log(vprec_log_depth,
-                           " - %s\tinput[%u]\tdouble_ptr\t%s\tNULL\t->\tNULL\n",
-                           function_inst->id, j, arg_id);
-          continue;
+                           " - %s\tinput[%u]\tdouble_ptr\t%s\t%la\t->\t",
+                           function_inst->id, j, arg_id, value[j]);
         }
 
-        _vprec_print_log(vprec_log_depth,
-                         " - %s\tinput[%u]\tdouble_ptr\t%s\t%la\t->\t",
-                         function_inst->id, j, arg_id, *value);
-
-        if ((!new_flag) && mode_flag) {
-          *value = _vprec_round_binary64(
-              *value, 1, context, function_inst->input_args[i].exponent_length,
+        if (round_flag) {
+          value[j] = _vprec_round_binary64(
+              value[j], 1, context,
+              function_inst->input_args[i].exponent_length,
               function_inst->input_args[i].mantissa_length);
         }
 
-        if (!(isnan(*value) || isinf(*value))) {
+        if (!sampled)
+          continue;
+
+        if (!(isnan(value[j]) || isinf(value[j]))) {
           function_inst->input_args[i].min_range =
-              (floor(*value) < function_inst->input_args[i].min_range ||
+              (floor(value[j]) < function_inst->input_args[i].min_range ||
                new_flag)
-                  ? floor(*value)
+                  ? floor(value[j])
                   : function_inst->input_args[i].min_range;
           function_inst->input_args[i].max_range =
-              (ceil(*value) > function_inst->input_args[i].max_range ||
+              (ceil(value[j]) > function_inst->input_args[i].max_range ||
                new_flag)
-                  ? ceil(*value)
+                  ? ceil(value[j])
                   : function_inst->input_args[i].max_range;
         }
 
-        _vprec_print_log(vprec_log_depth, "%la\t(%d, %d)\n", *value,
+        _vprec_print_log(vprec_log_depth, "%la\t(%d, %d)\n", value[j],
                          function_inst->input_args[i].mantissa_length,
                          function_inst->input_args[i].exponent_length);
+
+        sample = _vprec_sample_next(j, size, &budget);
       }
     } else if (type == FFLOAT_PTR) {
-      float *value = va_arg(ap, float *);
+      float *value = (float *)args[i].value;
 
-      for (unsigned int j = 0; j < size; j++, value++) {
-        if (value == NULL) {
+      if (value == NULL) {
+        _vprec_print_log(vprec_log_depth,
+                         " - %s\tinput[0]\tfloat_ptr\t%s\tNULL\t->\tNULL\n",
+                         function_inst->id, arg_id);
+        continue;
+      }
+
+      // every element is visited when arguments are rounded, only the sampled
+      // ones otherwise
+      unsigned int budget;
+      unsigned int sample = _vprec_sample_first(record_flag, size, &budget);
+      for (unsigned int j = round_flag ? 0 : sample; j < size;
+           j = round_flag ? j + 1 : sample) {
+        int sampled = (j == sample);
+
+        if (sampled) {
           _vprec_print_log(vprec_log_depth,
-                           " - %s\tinput[%u]\tfloat_ptr\t%s\tNULL\t->\tNULL\n",
-                           function_inst->id, j, arg_id);
-          continue;
+                           " - %s\tinput[%u]\tfloat_ptr\t%s\t%a\t->\t",
+                           function_inst->id, j, arg_id, value[j]);
         }
 
-        _vprec_print_log(vprec_log_depth,
-                         " - %s\tinput[%u]\tfloat_ptr\t%s\t%a\t->\t",
-                         function_inst->id, j, arg_id, *value);
-
-        if ((!new_flag) && mode_flag) {
-          *value = _vprec_round_binary32(
-              *value, 1, context, function_inst->input_args[i].exponent_length,
+        if (round_flag) {
+          value[j] = _vprec_round_binary32(
+              value[j], 1, context,
+              function_inst->input_args[i].exponent_length,
               function_inst->input_args[i].mantissa_length);
         }
 
-        if (!(isnan(*value) || isinf(*value))) {
+        if (!sampled)
+          continue;
+
+        if (!(isnan(value[j]) || isinf(value[j]))) {
           function_inst->input_args[i].min_range =
-              (floorf(*value) < function_inst->input_args[i].min_range ||
+              (floorf(value[j]) < function_inst->input_args[i].min_range ||
                new_flag)
-                  ? floorf(*value)
+                  ? floorf(value[j])
                   : function_inst->input_args[i].min_range;
           function_inst->input_args[i].max_range =
-              (ceilf(*value) > function_inst->input_args[i].max_range ||
+              (ceilf(value[j]) > function_inst->input_args[i].max_range ||
                new_flag)
-                  ? ceilf(*value)
+                  ? ceilf(value[j])
                   : function_inst->input_args[i].max_range;
         }
 
-        _vprec_print_log(vprec_log_depth, "%a\t(%d, %d)\n", *value,
+        _vprec_print_log(vprec_log_depth, "%a\t(%d, %d)\n", value[j],
                          function_inst->input_args[i].mantissa_length,
                          function_inst->input_args[i].exponent_length);
+
+        sample = _vprec_sample_next(j, size, &budget);
       }
     }
   }
@@ -1021,7 +1559,7 @@ void _interflop_enter_function(interflop_function_stack_t *stack, void *context,
 // Set precision for internal operations and round output arguments for a given
 // function call
 void _interflop_exit_function(interflop_function_stack_t *stack, void *context,
-                              int nb_args, va_list ap) {
+                              int nb_args, interflop_function_arg_t *args) {
   interflop_function_info_t *function_info = stack->array[stack->top];
 
   // decrement depth
@@ -1030,30 +1568,17 @@ void _interflop_exit_function(interflop_function_stack_t *stack, void *context,
   if (function_info == NULL)
     logger_error("Call stack error \n");
 
-  _vprec_inst_function_t *function_inst = vfc_hashmap_get(
-      _vprec_func_map, vfc_hashmap_str_function(function_info->id));
-
-  // set internal operations precision with parent function values
-  if (stack->array[stack->top + 1] != NULL) {
-    interflop_function_info_t *parent_info = stack->array[stack->top + 1];
-
-    if (!parent_info->isLibraryFunction && !parent_info->isIntrinsicFunction &&
-        VPREC_INST_MODE != vprecinst_arg && VPREC_INST_MODE != vprecinst_none) {
-
-      _vprec_inst_function_t *function_parent = vfc_hashmap_get(
-          _vprec_func_map, vfc_hashmap_str_function(parent_info->id));
+  _vprec_inst_function_t *function_inst =
+      (vprec_cct_depth > 0) ? _vprec_cct_exit()
+                            : _vprec_get_function(function_info);
 
-      if (function_parent != NULL) {
-        _set_vprec_precision_binary64(function_parent->OpsPrec64);
-        _set_vprec_range_binary64(function_parent->OpsRange64);
-        _set_vprec_precision_binary32(function_parent->OpsPrec32);
-        _set_vprec_range_binary32(function_parent->OpsRange32);
-      }
-    }
-  }
+  // restore internal operations precision of the caller
+  unsigned int n_call = _vprec_pop_precision();
 
   // treatment of arguments
-  int new_flag = (function_inst->output_args == NULL && nb_args > 0);
+  int new_flag =
+      _vprec_init_args(&function_inst->output_args,
+                       &function_inst->nb_output_args, nb_args, args);
 
   // print function info in log
   _vprec_print_log(vprec_log_depth, "exit of %s\t%d\t%d\t%d\t%d\n",
@@ -1061,13 +1586,6 @@ void _interflop_exit_function(interflop_function_stack_t *stack, void *context,
                    function_inst->OpsRange64, function_inst->OpsPrec32,
                    function_inst->OpsRange32);
 
-  // allocate memory for arguments
-  if (new_flag) {
-    function_inst->output_args =
-        malloc(sizeof(_vprec_argument_data_t) * nb_args);
-    function_inst->nb_output_args = nb_args;
-  }
-
   // boolean which indicates if arguments should be rounded or not depending on
   // modes
   int mode_flag =
@@ -1075,39 +1593,34 @@ void _interflop_exit_function(interflop_function_stack_t *stack, void *context,
        (VPREC_INST_MODE == vprecinst_all || VPREC_INST_MODE == vprecinst_arg) &&
        VPREC_INST_MODE != vprecinst_none);
 
+  // arguments are rounded on every call, their ranges and logs are only
+  // recorded on the sampled calls
+  int round_flag = (!new_flag) && mode_flag;
+  int record_flag = new_flag || _vprec_sample_call(n_call);
+
   for (int i = 0; i < nb_args; i++) {
-    int type = va_arg(ap, int);
-    char *arg_id = va_arg(ap, char *);
-    unsigned int size = va_arg(ap, unsigned int);
-
-    if (new_flag) {
-      // initialize arguments data
-      function_inst->output_args[i].data_type = type;
-      strcpy(function_inst->output_args[i].arg_id, arg_id);
-      function_inst->output_args[i].exponent_length =
-          (type == FDOUBLE || type == FDOUBLE_PTR)
-              ? VPREC_RANGE_BINARY64_DEFAULT
-              : VPREC_RANGE_BINARY32_DEFAULT;
-      function_inst->output_args[i].mantissa_length =
-          (type == FDOUBLE || type == FDOUBLE_PTR)
-              ? VPREC_PRECISION_BINARY64_DEFAULT
-              : VPREC_PRECISION_BINARY32_DEFAULT;
-      function_inst->output_args[i].min_range = INT_MAX;
-      function_inst->output_args[i].max_range = INT_MIN;
-    }
+    int type = args[i].type;
+    const char *arg_id = args[i].name;
+    unsigned int size = args[i].size;
 
     if (type == FDOUBLE) {
-      double *value = va_arg(ap, double *);
+      double *value = (double *)args[i].value;
 
-      _vprec_print_log(vprec_log_depth, " - %s\toutput\tdouble\t%s\t%la\t->\t",
-                       function_inst->id, arg_id, *value);
+      if (record_flag) {
+        _vprec_print_log(vprec_log_depth,
+                         " - %s\toutput\tdouble\t%s\t%la\t->\t",
+                         function_inst->id, arg_id, *value);
+      }
 
-      if ((!new_flag) && mode_flag) {
+      if (round_flag) {
         *value = _vprec_round_binary64(
             *value, 0, context, function_inst->output_args[i].exponent_length,
             function_inst->output_args[i].mantissa_length);
       }
 
+      if (!record_flag)
+        continue;
+
       if (!(isnan(*value) || isinf(*value))) {
         function_inst->output_args[i].min_range =
             (floor(*value) < function_inst->output_args[i].min_range ||
@@ -1124,17 +1637,23 @@ void _interflop_exit_function(interflop_function_stack_t *stack, void *context,
                        function_inst->output_args[i].mantissa_length,
                        function_inst->output_args[i].exponent_length);
     } else if (type == FFLOAT) {
-      float *value = va_arg(ap, float *);
+      float *value = (float *)args[i].value;
 
-      _vprec_print_log(vprec_log_depth, " - %s\toutput\tfloat\t%s\t%a\t->\t",
-                       function_inst->id, arg_id, *value);
+      if (record_flag) {
+        _vprec_print_log(vprec_log_depth,
+                         " - %s\toutput\tfloat\t%s\t%a\t->\t",
+                         function_inst->id, arg_id, *value);
+      }
 
-      if ((!new_flag) && mode_flag) {
+      if (round_flag) {
         *value = _vprec_round_binary32(
             *value, 0, context, function_inst->output_args[i].exponent_length,
             function_inst->output_args[i].mantissa_length);
       }
 
+      if (!record_flag)
+        continue;
+
       if (!(isnan(*value) || isinf(*value))) {
         function_inst->output_args[i].min_range =
             (floorf(*value) < function_inst->output_args[i].min_range ||
@@ -1152,81 +1671,110 @@ void _interflop_exit_function(interflop_function_stack_t *stack, void *context,
                        function_inst->output_args[i].mantissa_length,
                        function_inst->output_args[i].exponent_length);
     } else if (type == FDOUBLE_PTR) {
-      double *value = va_arg(ap, double *);
-
-      for (unsigned int j = 0; j < size; j++, value++) {
-        if (value == NULL) {
-          _vprec_print_log(
-              vprec_log_depth,
-              " - %s\toutput[%u]\tdouble_ptr\t%s\tNULL\t->\tNULL\n",
-              function_inst->id, j, arg_id);
-          continue;
-        }
+      double *value = (double *)args[i].value;
 
+      if (value == NULL) {
         _vprec_print_log(vprec_log_depth,
-                         " - %s\toutput[%u]\tdouble_ptr\t%s\t%la\t->\t",
-                         function_inst->id, j, arg_id, *value);
+                         " - %s\toutput[0]\tdouble_ptr\t%s\tNULL\t->\tNULL\n",
+                         function_inst->id, arg_id);
+        continue;
+      }
+
+      // every element is visited when arguments are rounded, only the sampled
+      // ones otherwise
+      unsigned int budget;
+      unsigned int sample = _vprec_sample_first(record_flag, size, &budget);
+      for (unsigned int j = round_flag ? 0 : sample; j < size;
+           j = round_flag ? j + 1 : sample) {
+        int sampled = (j == sample);
 
-        if ((!new_flag) && mode_flag) {
-          *value = _vprec_round_binary64(
-              *value, 0, context, function_inst->output_args[i].exponent_length,
+        if (sampled) {
+          _vprec_print_log(vprec_log_depth,
+                           " - %s\toutput[%u]\tdouble_ptr\t%s\t%la\t->\t",
+                           function_inst->id, j, arg_id, value[j]);
+        }
+
+        if (round_flag) {
+          value[j] = _vprec_round_binary64(
+              value[j], 0, context,
+              function_inst->output_args[i].exponent_length,
               function_inst->output_args[i].mantissa_length);
         }
 
-        if (!(isnan(*value) || isinf(*value))) {
+        if (!sampled)
+          continue;
+
+        if (!(isnan(value[j]) || isinf(value[j]))) {
           function_inst->output_args[i].min_range =
-              (floor(*value) < function_inst->output_args[i].min_range ||
+              (floor(value[j]) < function_inst->output_args[i].min_range ||
                new_flag)
-                  ? floor(*value)
+                  ? floor(value[j])
                   : function_inst->output_args[i].min_range;
           function_inst->output_args[i].max_range =
-              (ceil(*value) > function_inst->output_args[i].max_range ||
+              (ceil(value[j]) > function_inst->output_args[i].max_range ||
                new_flag)
-                  ? ceil(*value)
+                  ? ceil(value[j])
                   : function_inst->output_args[i].max_range;
         }
 
-        _vprec_print_log(vprec_log_depth, "%la\t(%d,%d)\n", *value,
+        _vprec_print_log(vprec_log_depth, "%la\t(%d,%d)\n", value[j],
                          function_inst->output_args[i].mantissa_length,
                          function_inst->output_args[i].exponent_length);
+
+        sample = _vprec_sample_next(j, size, &budget);
       }
     } else if (type == FFLOAT_PTR) {
-      float *value = va_arg(ap, float *);
+      float *value = (float *)args[i].value;
 
-      for (unsigned int j = 0; j < size; j++, value++) {
-        if (value == NULL) {
+      if (value == NULL) {
+        _vprec_print_log(vprec_log_depth,
+                         " - %s\toutput[0]\tfloat_ptr\t%s\tNULL\t->\tNULL\n",
+                         function_inst->id, arg_id);
+        continue;
+      }
+
+      // every element is visited when arguments are rounded, only the sampled
+      // ones otherwise
+      unsigned int budget;
+      unsigned int sample = _vprec_sample_first(record_flag, size, &budget);
+      for (unsigned int j = round_flag ? 0 : sample; j < size;
+           j = round_flag ? j + 1 : sample) {
+        int sampled = (j == sample);
+
+        if (sampled) {
           _vprec_print_log(vprec_log_depth,
-                           " - %s\toutput[%u]\tfloat_ptr\t%s\tNULL\t->\tNULL\n",
-                           function_inst->id, j, arg_id);
-          continue;
+                           " - %s\toutput[%u]\tfloat_ptr\t%s\t%a\t->\t",
+                           function_inst->id, j, arg_id, value[j]);
         }
 
-        _vprec_print_log(vprec_log_depth,
-                         " - %s\toutput[%u]\tfloat_ptr\t%s\t%a\t->\t",
-                         function_inst->id, j, arg_id, *value);
-
-        if ((!new_flag) && mode_flag) {
-          *value = _vprec_round_binary32(
-              *value, 0, context, function_inst->output_args[i].exponent_length,
+        if (round_flag) {
+          value[j] = _vprec_round_binary32(
+              value[j], 0, context,
+              function_inst->output_args[i].exponent_length,
               function_inst->output_args[i].mantissa_length);
         }
 
-        if (!(isnan(*value) || isinf(*value))) {
+        if (!sampled)
+          continue;
+
+        if (!(isnan(value[j]) || isinf(value[j]))) {
           function_inst->output_args[i].min_range =
-              (floorf(*value) < function_inst->output_args[i].min_range ||
+              (floorf(value[j]) < function_inst->output_args[i].min_range ||
                new_flag)
-                  ? floorf(*value)
+                  ? floorf(value[j])
                   : function_inst->output_args[i].min_range;
           function_inst->output_args[i].max_range =
-              (ceilf(*value) > function_inst->output_args[i].max_range ||
+              (ceilf(value[j]) > function_inst->output_args[i].max_range ||
                new_flag)
-                  ? ceilf(*value)
+                  ? ceilf(value[j])
                   : function_inst->output_args[i].max_range;
         }
 
-        _vprec_print_log(vprec_log_depth, "%a\t(%d, %d)\n", *value,
+        _vprec_print_log(vprec_log_depth, "%a\t(%d, %d)\n", value[j],
                          function_inst->output_args[i].mantissa_length,
                          function_inst->output_args[i].exponent_length);
+
+        sample = _vprec_sample_next(j, size, &budget);
       }
     }
   }
@@ -1333,6 +1881,21 @@ static struct argp_option options[] = {
      "denormals-are-zero: sets denormals inputs to zero", 0},
     {key_ftz_str, KEY_FTZ, 0, 0, "flush-to-zero: sets denormal output to zero",
      0},
+    {key_cct_depth_str, KEY_CCT_DEPTH, "DEPTH", 0,
+     "keep function records per calling context of the last DEPTH call sites "
+     "instead of per call site (0 by default)",
+     0},
+    {key_sample_calls_str, KEY_SAMPLE_CALLS, "N", 0,
+     "record the ranges of the arguments on one call out of N (1 by default)",
+     0},
+    {key_sample_elements_str, KEY_SAMPLE_ELEMENTS, "RATE", 0,
+     "record each element of pointer arguments with probability RATE "
+     "(1 by default)",
+     0},
+    {key_max_sample_elements_str, KEY_MAX_SAMPLE_ELEMENTS, "N", 0,
+     "record at most N elements per pointer argument and call "
+     "(0 for no limit, by default)",
+     0},
     {0}};
 
 static error_t parse_opt(int key, char *arg, struct argp_state *state) {
@@ -1485,6 +2048,53 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     /* flush-to-zero */
     ctx->ftz = true;
     break;
+  case KEY_CCT_DEPTH:
+    /* calling context depth */
+    errno = 0;
+    val = strtol(arg, &endptr, 10);
+    if (errno != 0 || *endptr != '\0' || val < 0) {
+      logger_error("--%s invalid value provided, must be a "
+                   "positive integer.",
+                   key_cct_depth_str);
+    } else {
+      _set_vprec_cct_depth(val);
+    }
+    break;
+  case KEY_SAMPLE_CALLS:
+    /* calls sampling period */
+    errno = 0;
+    val = strtol(arg, &endptr, 10);
+    if (errno != 0 || *endptr != '\0' || val < 1) {
+      logger_error("--%s invalid value provided, must be a "
+                   "strictly positive integer.",
+                   key_sample_calls_str);
+    } else {
+      _set_vprec_sample_calls(val);
+    }
+    break;
+  case KEY_SAMPLE_ELEMENTS:
+    /* elements sampling rate */
+    errno = 0;
+    double rate = strtod(arg, &endptr);
+    if (errno != 0 || *endptr != '\0' || !(0 < rate && rate <= 1)) {
+      logger_error("--%s invalid value provided, must be in (0, 1].",
+                   key_sample_elements_str);
+    } else {
+      _set_vprec_sample_elements(rate);
+    }
+    break;
+  case KEY_MAX_SAMPLE_ELEMENTS:
+    /* maximum number of recorded elements */
+    errno = 0;
+    val = strtol(arg, &endptr, 10);
+    if (errno != 0 || *endptr != '\0' || val < 0) {
+      logger_error("--%s invalid value provided, must be a "
+                   "positive integer.",
+                   key_max_sample_elements_str);
+    } else {
+      _set_vprec_max_sample_elements(val);
+    }
+    break;
   case KEY_PRESET:
     /* preset */
     if (strcmp(VPREC_PRESET_STR[preset_binary16], arg) == 0) {
@@ -1564,8 +2174,12 @@ void print_information_header(void *context) {
       "%s = %s, "
       "%s = %d, "
       "%s = %s, "
-      "%s = %s and "
-      "%s = %s"
+      "%s = %s, "
+      "%s = %s, "
+      "%s = %d, "
+      "%s = %u, "
+      "%s = %g and "
+      "%s = %u"
       "\n",
       key_prec_b32_str, VPRECLIB_BINARY32_PRECISION, key_range_b32_str,
       VPRECLIB_BINARY32_RANGE, key_prec_b64_str, VPRECLIB_BINARY64_PRECISION,
@@ -1580,7 +2194,10 @@ void print_information_header(void *context) {
                       : VPREC_ERR_MODE_STR[vprec_err_mode_rel],
       key_err_exp_str, (ctx->absErr_exp), key_daz_str,
       ctx->daz ? "true" : "false", key_ftz_str, ctx->ftz ? "true" : "false",
-      key_instrument_str, VPREC_INST_MODE_STR[VPREC_INST_MODE]);
+      key_instrument_str, VPREC_INST_MODE_STR[VPREC_INST_MODE],
+      key_cct_depth_str, vprec_cct_depth, key_sample_calls_str,
+      vprec_sample_calls, key_sample_elements_str, vprec_sample_elements,
+      key_max_sample_elements_str, vprec_max_sample_elements);
 }
 
 void _interflop_finalize(__attribute__((unused)) void *context) {
@@ -1605,6 +2222,18 @@ void _interflop_finalize(__attribute__((unused)) void *context) {
 
   /* destroy vprec_function_map */
   vfc_hashmap_destroy(_vprec_func_map);
+
+  /* free the calling context tree */
+  _vprec_cct_free(&_vprec_cct_root);
+
+  /* free the cursor and the precision stack of the main thread */
+  _vprec_thread_free(NULL);
+
+  /* free the table of records, they were owned by the hashmap */
+  for (int i = 0; i < _VPREC_FUNC_CHUNK_NUMBER; i++) {
+    free(_vprec_func_table[i]);
+    _vprec_func_table[i] = NULL;
+  }
 }
 
 struct interflop_backend_interface_t interflop_init(int argc, char **argv,
@@ -1616,6 +2245,11 @@ struct interflop_backend_interface_t interflop_init(int argc, char **argv,
   /* Initialize the vprec_function_map */
   _vprec_func_map = vfc_hashmap_create();
 
+  /* Free the per-thread stacks of the threads when they exit */
+  if (pthread_key_create(&_vprec_thread_key, _vprec_thread_free) != 0) {
+    logger_error("Cannot create the thread key\n");
+  }
+
   /* Setting to default values */
   _set_vprec_precision_binary32(VPREC_PRECISION_BINARY32_DEFAULT);
   _set_vprec_precision_binary64(VPREC_PRECISION_BINARY64_DEFAULT);
@@ -1657,7 +2291,15 @@ struct interflop_backend_interface_t interflop_init(int argc, char **argv,
       _interflop_enter_function,
       _interflop_exit_function,
       _interflop_user_call,
-      _interflop_finalize};
+      _interflop_finalize,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL};
 
   return interflop_backend_vprec;
 }
@@ -48,4 +48,17 @@
 #define CTZ(X)                                                                 \
   _Generic(X, uint32_t : __builtin_ctz(X), uint64_t : __builtin_ctzl(X))
 
+/* Compiles the function for AVX-512, AVX2 and the default instruction set,
+   the version supported by the CPU is selected when the library is loaded.
+   Used for the loops that the compiler vectorizes. */
+#if defined(__x86_64__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define TARGET_CLONES                                                          \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+#endif
+#ifndef TARGET_CLONES
+#define TARGET_CLONES
+#endif
+
 #endif /* __GENERIC_BUILTIN_H__ */
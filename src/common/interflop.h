@@ -2,6 +2,7 @@
 #define __INTERFLOP_H__
 
 #include <stdarg.h>
+#include <stddef.h>
 
 /* interflop backend interface */
 
@@ -38,6 +39,10 @@ enum FTYPES {
 };
 
 typedef enum {
+  /* Allows perturbing an array of floating-point values */
+  /* signature: void inexact_array(enum FTYPES type, void *array, size_t n,
+   *                               int precision) */
+  INTERFLOP_INEXACT_ARRAY_ID = 6,
   /* Allows changing current virtual precision range */
   /* signature: void set_range_binary64(int precision) */
   INTERFLOP_SET_RANGE_BINARY64 = 5,
@@ -69,8 +74,23 @@ typedef struct interflop_function_info {
   short useFloat;
   // Indicate if the function use float
   short useDouble;
+  // Dense index of the function among all the instrumented functions,
+  // assigned when the descriptors of its module are registered
+  int index;
 } interflop_function_info_t;
 
+/* Floating-point argument of an instrumented function */
+typedef struct interflop_function_arg {
+  // Type of the argument (enum FTYPES)
+  int type;
+  // Number of elements pointed by value, 1 for scalar arguments
+  unsigned int size;
+  // Name of the argument
+  const char *name;
+  // Address of the argument
+  void *value;
+} interflop_function_arg_t;
+
 /* Verificarlo call stack */
 typedef struct interflop_function_stack {
   interflop_function_info_t **array;
@@ -93,15 +113,42 @@ struct interflop_backend_interface_t {
                                int *c, void *context);
 
   void (*interflop_enter_function)(interflop_function_stack_t *stack,
-                                   void *context, int nb_args, va_list ap);
+                                   void *context, int nb_args,
+                                   interflop_function_arg_t *args);
 
   void (*interflop_exit_function)(interflop_function_stack_t *stack,
-                                  void *context, int nb_args, va_list ap);
+                                  void *context, int nb_args,
+                                  interflop_function_arg_t *args);
 
   void (*interflop_user_call)(void *context, interflop_call_id id, va_list ap);
   /* interflop_finalize: called at the end of the instrumented program
    * execution */
   void (*interflop_finalize)(void *context);
+
+  /* Optional hooks for the vector operations: c[i] = a[i] op b[i] for the
+   * size lanes. The lanes of the backends which do not provide them are
+   * computed one at a time with the scalar hooks. */
+  void (*interflop_add_float_vector)(int size, const float *a, const float *b,
+                                     float *c, void *context);
+  void (*interflop_sub_float_vector)(int size, const float *a, const float *b,
+                                     float *c, void *context);
+  void (*interflop_mul_float_vector)(int size, const float *a, const float *b,
+                                     float *c, void *context);
+  void (*interflop_div_float_vector)(int size, const float *a, const float *b,
+                                     float *c, void *context);
+
+  void (*interflop_add_double_vector)(int size, const double *a,
+                                      const double *b, double *c,
+                                      void *context);
+  void (*interflop_sub_double_vector)(int size, const double *a,
+                                      const double *b, double *c,
+                                      void *context);
+  void (*interflop_mul_double_vector)(int size, const double *a,
+                                      const double *b, double *c,
+                                      void *context);
+  void (*interflop_div_double_vector)(int size, const double *a,
+                                      const double *b, double *c,
+                                      void *context);
 };
 
 /* interflop_init: called at initialization before using a backend.
@@ -0,0 +1,284 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2022                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+// Vector support shared by the MCA and MCA integer backends.
+//
+// The first part selects the instruction sets at runtime, it is included
+// once at the top of the backend. The second part is a template of the
+// lane helpers, included by the kernels of the backend once per instruction
+// set, with the following macros defined:
+//
+//   MCA_SIMD_ISA     suffix of the generated functions
+//   MCA_SIMD_TARGET  target attribute of the generated functions
+//   MCA_SIMD_LANES   number of binary64 lanes of a vector
+//   MCA_SIMD_FMA     fused multiply-add of three vectors of binary64
+//
+// It also needs MCA_DD_EXP_MIN and MCA_DD_EXP_MAX, the exponent range of
+// the double-double lanes. The kernels undefine the macros of the template
+// at their end.
+
+#ifndef MCA_SIMD_H
+#define MCA_SIMD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "float_const.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define MCA_HAVE_SIMD 1
+#else
+#define MCA_HAVE_SIMD 0
+#endif
+
+#define MCA_SIMD_LANES_MAX 8
+
+/* define the available vector kernels */
+typedef enum {
+  mca_simd_auto,
+  mca_simd_none,
+  mca_simd_avx2,
+  mca_simd_avx512,
+  _mca_simd_end_
+} mca_simd;
+
+static const char *MCA_SIMD_STR[] = {"auto", "none", "avx2", "avx512"};
+
+/* Returns true if the CPU supports the kernels of simd */
+static bool _mca_simd_supported(const mca_simd simd) {
+#if MCA_HAVE_SIMD
+  __builtin_cpu_init();
+  switch (simd) {
+  case mca_simd_avx2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  case mca_simd_avx512:
+    return __builtin_cpu_supports("avx512f");
+  default:
+    break;
+  }
+#endif
+  return simd == mca_simd_none;
+}
+
+/* Returns simd, or the widest kernels supported by the CPU for auto */
+static mca_simd _mca_simd_resolve(const mca_simd simd) {
+  if (simd != mca_simd_auto) {
+    return simd;
+  }
+  return _mca_simd_supported(mca_simd_avx512) ? mca_simd_avx512
+         : _mca_simd_supported(mca_simd_avx2) ? mca_simd_avx2
+                                              : mca_simd_none;
+}
+
+#endif /* MCA_SIMD_H */
+
+#ifdef MCA_SIMD_ISA
+
+#define _MCA_SIMD_CAT2(X, Y) X##_##Y
+#define _MCA_SIMD_CAT(X, Y) _MCA_SIMD_CAT2(X, Y)
+#define _MCA_SIMD(X) _MCA_SIMD_CAT(X, MCA_SIMD_ISA)
+
+#define _MCA_SIMD_INLINE                                                       \
+  static inline __attribute__((target(MCA_SIMD_TARGET), always_inline))
+
+typedef double _MCA_SIMD(mca_vd_t)
+    __attribute__((vector_size(MCA_SIMD_LANES * sizeof(double))));
+typedef uint64_t _MCA_SIMD(mca_vu_t)
+    __attribute__((vector_size(MCA_SIMD_LANES * sizeof(uint64_t))));
+typedef int64_t _MCA_SIMD(mca_vi_t)
+    __attribute__((vector_size(MCA_SIMD_LANES * sizeof(int64_t))));
+typedef float _MCA_SIMD(mca_vf_t)
+    __attribute__((vector_size(MCA_SIMD_LANES * sizeof(float))));
+typedef int32_t _MCA_SIMD(mca_vi32_t)
+    __attribute__((vector_size(MCA_SIMD_LANES * sizeof(int32_t))));
+
+#define _VD _MCA_SIMD(mca_vd_t)
+#define _VU _MCA_SIMD(mca_vu_t)
+#define _VI _MCA_SIMD(mca_vi_t)
+#define _VF _MCA_SIMD(mca_vf_t)
+#define _VI32 _MCA_SIMD(mca_vi32_t)
+
+typedef struct {
+  _VD hi;
+  _VD lo;
+} _MCA_SIMD(mca_vdd_t);
+
+#define _VDD _MCA_SIMD(mca_vdd_t)
+
+/* lane-parallel xoroshiro128++ */
+typedef struct {
+  _VU s0;
+  _VU s1;
+} _MCA_SIMD(mca_vrng_t);
+
+#define _VRNG _MCA_SIMD(mca_vrng_t)
+
+_MCA_SIMD_INLINE _VU _MCA_SIMD(_mca_simd_rotl)(const _VU x, const int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+/* Returns a random 64-bit integer in each lane */
+_MCA_SIMD_INLINE _VU _MCA_SIMD(_mca_simd_next)(_VRNG *rng) {
+  const _VU s0 = rng->s0;
+  const _VU s1 = rng->s1 ^ s0;
+  const _VU r = _MCA_SIMD(_mca_simd_rotl)(s0 + rng->s1, 17) + s0;
+  rng->s0 = _MCA_SIMD(_mca_simd_rotl)(s0, 49) ^ s1 ^ (s1 << 21);
+  rng->s1 = _MCA_SIMD(_mca_simd_rotl)(s1, 28);
+  return r;
+}
+
+/* Returns a random number in [-0.5, 0.5) in each lane */
+_MCA_SIMD_INLINE _VD _MCA_SIMD(_mca_simd_rand)(_VRNG *rng) {
+  const _VU r = _MCA_SIMD(_mca_simd_next)(rng);
+  return (_VD)((r >> 12) | ((uint64_t)DOUBLE_EXP_COMP << DOUBLE_PMAN_SIZE)) -
+         1.5;
+}
+
+/* Returns the lanes to perturb with the given sparsity */
+_MCA_SIMD_INLINE _VI _MCA_SIMD(_mca_simd_sparse)(const float sparsity,
+                                                 _VRNG *rng) {
+  if (sparsity >= 1.0f) {
+    const _VI all = {0};
+    return ~all;
+  }
+  return (_MCA_SIMD(_mca_simd_rand)(rng) + 0.5) <= (double)sparsity;
+}
+
+/* Returns the unbiased exponent of each lane */
+_MCA_SIMD_INLINE _VI _MCA_SIMD(_mca_simd_exponent)(const _VD x) {
+  return (_VI)(((_VU)x >> DOUBLE_PMAN_SIZE) & DOUBLE_EXP_INF) -
+         DOUBLE_EXP_COMP;
+}
+
+/* Returns the lanes of x selected by mask and the lanes of y otherwise */
+_MCA_SIMD_INLINE _VD _MCA_SIMD(_mca_simd_select)(const _VI mask, const _VD x,
+                                                 const _VD y) {
+  return (_VD)(((_VI)x & mask) | ((_VI)y & ~mask));
+}
+
+/* Returns rand * 2^e in each lane */
+_MCA_SIMD_INLINE _VD _MCA_SIMD(_mca_simd_noise)(const _VI e, _VRNG *rng) {
+  const _VD pow2 = (_VD)((_VU)(e + DOUBLE_EXP_COMP) << DOUBLE_PMAN_SIZE);
+  return _MCA_SIMD(_mca_simd_rand)(rng) * pow2;
+}
+
+/* Lanes which are neither zero, infinite nor NaN */
+_MCA_SIMD_INLINE _VI _MCA_SIMD(_mca_simd_is_noised)(const _VD x) {
+  return (x != 0) & (((_VU)x & DOUBLE_GET_EXP) != DOUBLE_GET_EXP);
+}
+
+/* Lanes representable with a virtual precision of 53 - log2(mask + 1) */
+_MCA_SIMD_INLINE _VI _MCA_SIMD(_mca_simd_is_representable)(const _VD x,
+                                                           const uint64_t m) {
+  return ((_VU)x & m) == 0;
+}
+
+/******************** DOUBLE-DOUBLE LANES ********************/
+
+_MCA_SIMD_INLINE _VDD _MCA_SIMD(_mca_simd_two_sum)(const _VD a, const _VD b) {
+  const _VD s = a + b;
+  const _VD bb = s - a;
+  const _VD e = (a - (s - bb)) + (b - bb);
+  return (_VDD){s, e};
+}
+
+_MCA_SIMD_INLINE _VDD _MCA_SIMD(_mca_simd_fast_two_sum)(const _VD a,
+                                                        const _VD b) {
+  const _VD s = a + b;
+  const _VD e = b - (s - a);
+  return (_VDD){s, e};
+}
+
+_MCA_SIMD_INLINE _VDD _MCA_SIMD(_mca_simd_two_prod)(const _VD a, const _VD b) {
+  const _VD p = a * b;
+  const _VD e = MCA_SIMD_FMA(a, b, -p);
+  return (_VDD){p, e};
+}
+
+_MCA_SIMD_INLINE _VDD _MCA_SIMD(_mca_simd_dd_add_d)(const _VDD x,
+                                                    const _VD b) {
+  _VDD s = _MCA_SIMD(_mca_simd_two_sum)(x.hi, b);
+  s.lo += x.lo;
+  return _MCA_SIMD(_mca_simd_fast_two_sum)(s.hi, s.lo);
+}
+
+_MCA_SIMD_INLINE _VDD _MCA_SIMD(_mca_simd_dd_add)(const _VDD x,
+                                                  const _VDD y) {
+  _VDD s = _MCA_SIMD(_mca_simd_two_sum)(x.hi, y.hi);
+  const _VDD t = _MCA_SIMD(_mca_simd_two_sum)(x.lo, y.lo);
+  s.lo += t.hi;
+  s = _MCA_SIMD(_mca_simd_fast_two_sum)(s.hi, s.lo);
+  s.lo += t.lo;
+  return _MCA_SIMD(_mca_simd_fast_two_sum)(s.hi, s.lo);
+}
+
+_MCA_SIMD_INLINE _VDD _MCA_SIMD(_mca_simd_dd_neg)(const _VDD x) {
+  return (_VDD){-x.hi, -x.lo};
+}
+
+_MCA_SIMD_INLINE _VDD _MCA_SIMD(_mca_simd_dd_mul_d)(const _VDD x,
+                                                    const _VD b) {
+  _VDD p = _MCA_SIMD(_mca_simd_two_prod)(x.hi, b);
+  p.lo += x.lo * b;
+  return _MCA_SIMD(_mca_simd_fast_two_sum)(p.hi, p.lo);
+}
+
+_MCA_SIMD_INLINE _VDD _MCA_SIMD(_mca_simd_dd_mul)(const _VDD x,
+                                                  const _VDD y) {
+  _VDD p = _MCA_SIMD(_mca_simd_two_prod)(x.hi, y.hi);
+  p.lo += MCA_SIMD_FMA(x.hi, y.lo, x.lo * y.hi);
+  return _MCA_SIMD(_mca_simd_fast_two_sum)(p.hi, p.lo);
+}
+
+_MCA_SIMD_INLINE _VDD _MCA_SIMD(_mca_simd_dd_div)(const _VDD x,
+                                                  const _VDD y) {
+  const _VD q1 = x.hi / y.hi;
+  _VDD r = _MCA_SIMD(_mca_simd_dd_add)(
+      x, _MCA_SIMD(_mca_simd_dd_neg)(_MCA_SIMD(_mca_simd_dd_mul_d)(y, q1)));
+  const _VD q2 = r.hi / y.hi;
+  r = _MCA_SIMD(_mca_simd_dd_add)(
+      r, _MCA_SIMD(_mca_simd_dd_neg)(_MCA_SIMD(_mca_simd_dd_mul_d)(y, q2)));
+  const _VD q3 = r.hi / y.hi;
+  return _MCA_SIMD(_mca_simd_dd_add_d)(
+      _MCA_SIMD(_mca_simd_fast_two_sum)(q1, q2), q3);
+}
+
+/* Returns the unbiased exponent of the exact value hi + lo */
+_MCA_SIMD_INLINE _VI _MCA_SIMD(_mca_simd_dd_exponent)(const _VDD x) {
+  const _VI e = _MCA_SIMD(_mca_simd_exponent)(x.hi);
+  /* hi is a power of two rounded up from hi + lo */
+  const _VI pow2 = ((_VU)x.hi & DOUBLE_GET_PMAN) == 0;
+  const _VI lower = (x.lo != 0) & (((_VI)x.hi ^ (_VI)x.lo) < 0);
+  return e + (pow2 & lower);
+}
+
+/* Lanes which can be processed by the double-double path */
+_MCA_SIMD_INLINE _VI _MCA_SIMD(_mca_simd_dd_in_range)(const _VD x) {
+  const _VI e = _MCA_SIMD(_mca_simd_exponent)(x);
+  return (x == 0) | ((MCA_DD_EXP_MIN <= e) & (e <= MCA_DD_EXP_MAX));
+}
+
+/* Adds the noise of virtual precision t to the lanes of the */
+/* double-double x selected by mask */
+_MCA_SIMD_INLINE _VDD _MCA_SIMD(_mca_simd_dd_inexact)(const _VDD x,
+                                                      const int t,
+                                                      const _VI mask,
+                                                      _VRNG *rng) {
+  const _VI e = _MCA_SIMD(_mca_simd_dd_exponent)(x) - (t - 1);
+  const _VDD noised =
+      _MCA_SIMD(_mca_simd_dd_add_d)(x, _MCA_SIMD(_mca_simd_noise)(e, rng));
+  return (_VDD){_MCA_SIMD(_mca_simd_select)(mask, noised.hi, x.hi),
+                _MCA_SIMD(_mca_simd_select)(mask, noised.lo, x.lo)};
+}
+
+#endif /* MCA_SIMD_ISA */
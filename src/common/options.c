@@ -17,6 +17,7 @@
  *     Verificarlo Contributors                                              *\
  *                                                                           *\
  ****************************************************************************/
+#include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -44,14 +45,37 @@
     }                                                                          \
   }
 
-/* Returns a bool for determining whether an operation should skip */
-/* perturbation. false -> perturb; true -> skip. */
-/* e.g. for sparsity=0.1, all random values > 0.1 = true -> no MCA*/
-bool _mca_skip_eval(const float sparsity, rng_state_t *rng_state,
+/* Sparsity above which the operations are drawn one at a time */
+#define MCA_SKIP_GEOMETRIC_MAX 0.1f
+
+/* Returns the number of failures before the first success of Bernoulli */
+/* trials of probability p, i.e. floor(log(u) / log(1 - p)) for u in (0,1] */
+static uint64_t _geometric(const double p, rng_state_t *rng_state,
+                           pid_t *global_tid) {
+  const double u = 1.0 - get_rand_double01(rng_state, global_tid);
+  const double g = floor(log(u) / log1p(-p));
+  /* also catches the overflow of the conversion for tiny sparsities */
+  return (g < 0x1p63) ? (uint64_t)g : (UINT64_C(1) << 63);
+}
+
+/* Draws the number of operations to skip before the next perturbed one */
+/* Called by _mca_skip_eval once the previous gap has been consumed: the */
+/* current operation is the one that ends the gap, it is perturbed */
+bool _mca_skip_draw(const float sparsity, rng_state_t *rng_state,
                     pid_t *global_tid) {
-  if (sparsity >= 1.0f) {
-    return false;
+  if (sparsity > MCA_SKIP_GEOMETRIC_MAX) {
+    /* the gaps are too short to pay for the logarithms */
+    /* e.g. for sparsity=0.5, all random values > 0.5 = true -> no MCA */
+    return (get_rand_double01(rng_state, global_tid) > sparsity);
+  } else if (rng_state->skip_valid == false) {
+    /* the first gap starts before the first operation */
+    rng_state->skip_valid = true;
+    rng_state->skip = _geometric(sparsity, rng_state, global_tid);
+    if (rng_state->skip > 0) {
+      rng_state->skip--;
+      return true;
+    }
   }
-
-  return (get_rand_double01(rng_state, global_tid) > sparsity);
+  rng_state->skip = _geometric(sparsity, rng_state, global_tid);
+  return false;
 }
@@ -39,6 +39,14 @@
     *c = FUNC_NAME(a, b, OP_TYPE, context);                                    \
   }
 
+/* Same as _INTERFLOP_OP_CALL for the vector hooks, FUNC_NAME computes the */
+/* size lanes of a and b */
+#define _INTERFLOP_VECTOR_OP_CALL(TYPE, OP_NAME, OP_TYPE, FUNC_NAME)           \
+  static void _interflop_##OP_NAME##_##TYPE##_vector(                          \
+      int size, const TYPE *a, const TYPE *b, TYPE *c, void *context) {        \
+    FUNC_NAME(size, a, b, c, OP_TYPE, context);                                \
+  }
+
 /* Generic set_precision macro function which is common within most backends */
 /* BACKEND   is the name of the backend */
 /* PRECISION is the virtual precision to use */
@@ -66,13 +74,30 @@
     *T = PRECISION;                                                            \
   }
 
+/* Draws the number of operations to skip before the next perturbed one */
+/* @param sparsity sparsity */
+/* @param rng_state pointer to the structure holding all the RNG-related data */
+/* @return false -> perturb; true -> skip */
+bool _mca_skip_draw(const float sparsity, rng_state_t *rng_state,
+                    pid_t *global_tid);
+
 /* Returns a bool for determining whether an operation should skip */
 /* perturbation. false -> perturb; true -> skip. */
-/* e.g. for sparsity=0.1, all random values > 0.1 = true -> no MCA*/
+/* Each operation is perturbed with probability sparsity: rather than */
+/* drawing a random number per operation, the gap to the next perturbed */
+/* operation is drawn from the geometric distribution and counted down */
 /* @param sparsity sparsity */
 /* @param rng_state pointer to the structure holding all the RNG-related data */
 /* @return false -> perturb; true -> skip */
-bool _mca_skip_eval(const float sparsity, rng_state_t *rng_state,
-                    pid_t *global_tid);
+static inline bool _mca_skip_eval(const float sparsity, rng_state_t *rng_state,
+                                  pid_t *global_tid) {
+  if (sparsity >= 1.0f) {
+    return false;
+  } else if (rng_state->skip > 0) {
+    rng_state->skip--;
+    return true;
+  }
+  return _mca_skip_draw(sparsity, rng_state, global_tid);
+}
 
 #endif /* __OPTIONS_H__ */
@@ -11,10 +11,17 @@
  *                                                                           *\
  ****************************************************************************/
 
+#include <string.h>
+
 #include "vfc_rng.h"
 #include "splitmix64.h"
 #include "xoroshiro128.h"
 
+/* Seed of the states which have not been initialized with */
+/* _init_rng_state_struct, set by vfc_rng_set_seed */
+static bool _vfc_rng_choose_seed = false;
+static uint64_t _vfc_rng_seed = 0;
+
 /* A macro to initialize the initialization of the seed and random state for the
  * random number generator */
 /* RANDOM_STATE      is a pointer to the structure that all RNG-related data */
@@ -22,6 +29,10 @@
 #define _INIT_RANDOM_STATE(RANDOM_STATE, GLOBAL_TID)                           \
   {                                                                            \
     if (RANDOM_STATE->random_state_valid == false) {                           \
+      if (RANDOM_STATE->choose_seed == false && _vfc_rng_choose_seed) {        \
+        RANDOM_STATE->choose_seed = true;                                      \
+        RANDOM_STATE->seed = _vfc_rng_seed;                                    \
+      }                                                                        \
       if (RANDOM_STATE->choose_seed == true) {                                 \
         _set_seed(RANDOM_STATE, RANDOM_STATE->choose_seed,                     \
                   RANDOM_STATE->seed ^ _get_new_tid(GLOBAL_TID));              \
@@ -49,6 +60,13 @@ static void _set_seed(rng_state_t *random_state, const bool choose_seed,
   }
   random_state->random_state[0] = next_seed(random_state->seed);
   random_state->random_state[1] = next_seed(random_state->seed);
+  /* the streams are seeded with the first outputs of the generator */
+  for (int i = 0; i < VFC_RNG_STREAMS; i++) {
+    random_state->streams[0][i] = next(random_state->random_state);
+    random_state->streams[1][i] = next(random_state->random_state);
+  }
+  random_state->next = 0;
+  random_state->size = 0;
 }
 
 /* Get a new identifier for the calling thread */
@@ -72,24 +90,76 @@ void _init_rng_state_struct(rng_state_t *rng_state, bool choose_seed,
   }
 }
 
-/* Returns a 32-bit unsigned integer r (0 <= r < 2^32) */
-uint32_t get_rand_uint32(rng_state_t *rng_state, pid_t *global_tid) {
-  _INIT_RANDOM_STATE(rng_state, global_tid);
-  const union {
-    uint64_t u64;
-    uint32_t u32[2];
-  } u = {.u64 = next(rng_state->random_state)};
-  return u.u32[0];
+/* Set the seed of the states which have not been initialized */
+void vfc_rng_set_seed(bool choose_seed, uint64_t seed) {
+  _vfc_rng_choose_seed = choose_seed;
+  _vfc_rng_seed = seed;
+}
+
+/* xoroshiro128++ applied to VFC_RNG_STREAMS streams at once, the vector */
+/* extensions let the compiler use the SIMD registers of the target */
+typedef uint64_t vfc_rng_streams_t
+    __attribute__((vector_size(VFC_RNG_STREAMS * sizeof(uint64_t))));
+typedef double vfc_rng_streams_double_t
+    __attribute__((vector_size(VFC_RNG_STREAMS * sizeof(double))));
+
+#define _ROTL_STREAMS(X, K) (((X) << (K)) | ((X) >> (64 - (K))))
+
+/* The streams are passed by address, vectors wider than the baseline SIMD */
+/* registers have no stable calling convention */
+static inline void _next_streams(vfc_rng_streams_t *s0, vfc_rng_streams_t *s1,
+                                 vfc_rng_streams_t *result) {
+  const vfc_rng_streams_t x0 = *s0;
+  const vfc_rng_streams_t x1 = *s1 ^ x0;
+  *result = _ROTL_STREAMS(x0 + *s1, 17) + x0;
+  *s0 = _ROTL_STREAMS(x0, 49) ^ x1 ^ (x1 << 21);
+  *s1 = _ROTL_STREAMS(x1, 28);
 }
 
-/* Returns a 64-bit unsigned integer r (0 <= r < 2^64) */
-uint64_t get_rand_uint64(rng_state_t *rng_state, pid_t *global_tid) {
+/* Fill buf with n 64-bit unsigned integers */
+void vfc_rng_fill_uint64(rng_state_t *rng_state, uint64_t *buf, size_t n,
+                         pid_t *global_tid) {
   _INIT_RANDOM_STATE(rng_state, global_tid);
-  return next(rng_state->random_state);
+  vfc_rng_streams_t s0, s1, r;
+  memcpy(&s0, rng_state->streams[0], sizeof(s0));
+  memcpy(&s1, rng_state->streams[1], sizeof(s1));
+  size_t i = 0;
+  for (; i + VFC_RNG_STREAMS <= n; i += VFC_RNG_STREAMS) {
+    _next_streams(&s0, &s1, &r);
+    memcpy(buf + i, &r, sizeof(r));
+  }
+  if (i < n) {
+    _next_streams(&s0, &s1, &r);
+    memcpy(buf + i, &r, (n - i) * sizeof(uint64_t));
+  }
+  memcpy(rng_state->streams[0], &s0, sizeof(s0));
+  memcpy(rng_state->streams[1], &s1, sizeof(s1));
 }
 
-/* Returns a random double in the (0,1) open interval */
-double get_rand_double01(rng_state_t *rng_state, pid_t *global_tid) {
+/* Fill buf with n floating point numbers in [0, 1) */
+void vfc_rng_fill_double01(rng_state_t *rng_state, double *buf, size_t n,
+                           pid_t *global_tid) {
   _INIT_RANDOM_STATE(rng_state, global_tid);
-  return next_double(rng_state->random_state);
+  vfc_rng_streams_t s0, s1, r;
+  vfc_rng_streams_double_t d;
+  memcpy(&s0, rng_state->streams[0], sizeof(s0));
+  memcpy(&s1, rng_state->streams[1], sizeof(s1));
+  size_t i = 0;
+  for (; i < n; i += VFC_RNG_STREAMS) {
+    _next_streams(&s0, &s1, &r);
+    /* same conversion as vfc_rng_uint64_to_double01 */
+    d = (vfc_rng_streams_double_t)((r >> 12) | (UINT64_C(0x3FF) << 52)) - 1.0;
+    const size_t m = (n - i < VFC_RNG_STREAMS) ? n - i : VFC_RNG_STREAMS;
+    memcpy(buf + i, &d, m * sizeof(double));
+  }
+  memcpy(rng_state->streams[0], &s0, sizeof(s0));
+  memcpy(rng_state->streams[1], &s1, sizeof(s1));
+}
+
+/* Refill the buffer of rng_state */
+void _vfc_rng_refill(rng_state_t *rng_state, pid_t *global_tid) {
+  vfc_rng_fill_uint64(rng_state, rng_state->buffer, VFC_RNG_BUFFER_SIZE,
+                      global_tid);
+  rng_state->next = 0;
+  rng_state->size = VFC_RNG_BUFFER_SIZE;
 }
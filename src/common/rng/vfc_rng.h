@@ -15,6 +15,7 @@
 
 #include <pthread.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
@@ -23,12 +24,30 @@
 #include "xoroshiro128.h"
 #define __INTERNAL_RNG_STATE xoroshiro_state
 
+/* Number of xoroshiro128++ streams advanced in parallel by the fill */
+/* functions */
+#define VFC_RNG_STREAMS 4
+
+/* Number of random numbers drawn in advance by each state */
+#define VFC_RNG_BUFFER_SIZE 64
+
 /* Data type used to hold information required by the RNG */
+/* A state filled with zeros is valid: it is initialized on its first draw */
 typedef struct rng_state {
   bool choose_seed;
   uint64_t seed;
   bool random_state_valid;
   __INTERNAL_RNG_STATE random_state;
+  /* streams seeded from random_state */
+  uint64_t streams[2][VFC_RNG_STREAMS];
+  /* numbers drawn in advance, buffer[next] is the next one to return */
+  uint32_t next;
+  uint32_t size;
+  uint64_t buffer[VFC_RNG_BUFFER_SIZE];
+  /* operations left to skip before the next perturbed one, the first gap */
+  /* is drawn by _mca_skip_eval when skip_valid is false */
+  uint64_t skip;
+  bool skip_valid;
 } rng_state_t;
 
 /* Get a new identifier for the calling thread */
@@ -48,25 +67,80 @@ pid_t _get_new_tid(pid_t *global_tid);
 void _init_rng_state_struct(rng_state_t *rng_state, bool choose_seed,
                             uint64_t seed, bool random_state_valid);
 
+/* Set the seed of the states which have not been initialized with */
+/* _init_rng_state_struct, such as the thread-local states of the threads */
+/* created after the initialization of a backend. Backends call it once from */
+/* interflop_init, so that the draws do not have to check their seed. */
+/* @param choose_seed whether to set the seed to a user-provided value */
+/* @param seed the user-provided seed for the RNG */
+void vfc_rng_set_seed(bool choose_seed, uint64_t seed);
+
+/* Fill buf with n 64-bit unsigned integers r (0 <= r < 2^64) */
+/* The numbers are drawn from VFC_RNG_STREAMS streams at once */
+/* Manages the internal state of the RNG, if necessary */
+/* @param rng_state pointer to the structure holding all the RNG-related data */
+/* @param buf array of at least n integers */
+/* @param n number of integers to draw */
+/* @param global_tid pointer to the unique TID */
+void vfc_rng_fill_uint64(rng_state_t *rng_state, uint64_t *buf, size_t n,
+                         pid_t *global_tid);
+
+/* Fill buf with n floating point numbers r (0.0 <= r < 1.0) */
+/* The numbers are drawn from VFC_RNG_STREAMS streams at once */
+/* Manages the internal state of the RNG, if necessary */
+/* @param rng_state pointer to the structure holding all the RNG-related data */
+/* @param buf array of at least n doubles */
+/* @param n number of doubles to draw */
+/* @param global_tid pointer to the unique TID */
+void vfc_rng_fill_double01(rng_state_t *rng_state, double *buf, size_t n,
+                           pid_t *global_tid);
+
+/* Refill the buffer of rng_state, called when it is empty */
+/* @param rng_state pointer to the structure holding all the RNG-related data */
+/* @param global_tid pointer to the unique TID */
+void _vfc_rng_refill(rng_state_t *rng_state, pid_t *global_tid);
+
+/* Returns a floating point number r (0.0 <= r < 1.0) built from the 52 */
+/* upper bits of x */
+static inline double vfc_rng_uint64_to_double01(const uint64_t x) {
+  const union {
+    uint64_t i;
+    double d;
+  } u = {.i = UINT64_C(0x3FF) << 52 | x >> 12};
+  return u.d - 1.0;
+}
+
 /* Returns a 64-bit unsigned integer r (0 <= r < 2^64) */
 /* Manages the internal state of the RNG, if necessary */
 /* @param rng_state pointer to the structure holding all the RNG-related data */
 /* @param global_tid pointer to the unique TID */
 /* @return a 64-bit unsigned integer r (0 <= r < 2^64) */
-uint64_t get_rand_uint64(rng_state_t *rng_state, pid_t *global_tid);
+static inline uint64_t get_rand_uint64(rng_state_t *rng_state,
+                                       pid_t *global_tid) {
+  if (rng_state->next == rng_state->size) {
+    _vfc_rng_refill(rng_state, global_tid);
+  }
+  return rng_state->buffer[rng_state->next++];
+}
 
 /* Returns a 32-bit unsigned integer r (0 <= r < 2^32) */
 /* Manages the internal state of the RNG, if necessary */
 /* @param rng_state pointer to the structure holding all the RNG-related data */
 /* @param global_tid pointer to the unique TID */
 /* @return a 32-bit unsigned integer r (0 <= r < 2^32) */
-uint32_t get_rand_uint32(rng_state_t *rng_state, pid_t *global_tid);
+static inline uint32_t get_rand_uint32(rng_state_t *rng_state,
+                                       pid_t *global_tid) {
+  return (uint32_t)get_rand_uint64(rng_state, global_tid);
+}
 
-/* Returns a random double in the (0,1) open interval */
+/* Returns a random double in the [0,1) interval */
 /* Manages the internal state of the RNG, if necessary */
 /* @param rng_state pointer to the structure holding all the RNG-related data */
 /* @param global_tid pointer to the unique TID */
-/* @return a floating point number r (0.0 < r < 1.0) */
-double get_rand_double01(rng_state_t *rng_state, pid_t *global_tid);
+/* @return a floating point number r (0.0 <= r < 1.0) */
+static inline double get_rand_double01(rng_state_t *rng_state,
+                                       pid_t *global_tid) {
+  return vfc_rng_uint64_to_double01(get_rand_uint64(rng_state, global_tid));
+}
 
 #endif /* __VFC_RNG_H__ */
@@ -0,0 +1,57 @@
+/*****************************************************************************\
+ *                                                                           *\
+ *  This file is part of the Verificarlo project,                            *\
+ *  under the Apache License v2.0 with LLVM Exceptions.                      *\
+ *  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception.                 *\
+ *  See https://llvm.org/LICENSE.txt for license information.                *\
+ *                                                                           *\
+ *                                                                           *\
+ *  Copyright (c) 2019-2022                                                  *\
+ *     Verificarlo Contributors                                              *\
+ *                                                                           *\
+ ****************************************************************************/
+// Escaping of the strings written in the JSON and CSV reports of the
+// instrumentation passes
+
+#ifndef VFC_REPORT_H
+#define VFC_REPORT_H
+
+#include <cstdio>
+#include <string>
+
+// Returns str as a JSON string literal, the control characters are escaped
+static inline std::string jsonEscape(const std::string &str) {
+  std::string escaped;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else if (c == '\t') {
+      escaped += "\\t";
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char code[7];
+      snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+      escaped += code;
+    } else {
+      escaped += c;
+    }
+  }
+  return "\"" + escaped + "\"";
+}
+
+// Returns str as a CSV field, quoted when it holds a separator, a quote or a
+// new line
+static inline std::string csvEscape(const std::string &str) {
+  if (str.find_first_of(",\"\r\n") == std::string::npos)
+    return str;
+  std::string escaped = str;
+  std::string quote = "\"";
+  for (size_t pos = escaped.find(quote); pos != std::string::npos;
+       pos = escaped.find(quote, pos + 2))
+    escaped.replace(pos, 1, "\"\"");
+  return quote + escaped + quote;
+}
+
+#endif /* VFC_REPORT_H */
@@ -18,9 +18,11 @@
  *                                                                           *\
  ****************************************************************************/
 #include "../../config.h"
+#include "../common/vfc_report.h"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
+#include "llvm/Analysis/CFG.h"
 #include "llvm/Analysis/CallGraphSCCPass.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/IR/DataLayout.h"
@@ -35,13 +37,17 @@
 #include "llvm/IR/Type.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ModuleUtils.h"
 #include "llvm/Transforms/Utils/UnifyFunctionExitNodes.h"
 #pragma GCC diagnostic pop
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <set>
 #include <stdio.h>
 #include <string>
@@ -56,20 +62,212 @@ typedef llvm::LibFunc _LibFunc;
 
 using namespace llvm;
 
+// VfclibFunc pass command line arguments
+static cl::opt<std::string> VfclibFuncReportFile(
+    "vfclibfunc-report-file",
+    cl::desc("Write an instrumentation report in ReportFile (.json or .csv)"),
+    cl::value_desc("ReportFile"), cl::init(""));
+
+static cl::opt<unsigned> VfclibFuncMinInstructions(
+    "vfclibfunc-min-instructions",
+    cl::desc("Do not instrument calls to functions of the module with less "
+             "than N instructions"),
+    cl::value_desc("N"), cl::init(0));
+
+static cl::opt<bool> VfclibFuncSkipLeaf(
+    "vfclibfunc-skip-leaf",
+    cl::desc("Do not instrument calls to functions of the module without "
+             "loops and calls"),
+    cl::init(false));
+
+static cl::opt<unsigned> VfclibFuncMaxDepth(
+    "vfclibfunc-max-depth",
+    cl::desc("Only instrument calls at most N calls deep from the functions "
+             "of the module which are not called in the module "
+             "(0 means no limit)"),
+    cl::value_desc("N"), cl::init(0));
+
+static cl::opt<bool> VfclibFuncSkipNoFPArgs(
+    "vfclibfunc-skip-no-fp-args",
+    cl::desc("Do not instrument calls without floating point arguments or "
+             "return value"),
+    cl::init(false));
+
 namespace {
 
 static Function *func_enter;
 static Function *func_exit;
 
-// Enumeration of managed types
-enum Ftypes { FLOAT, DOUBLE, FLOAT_PTR, DOUBLE_PTR };
+// Enumeration of managed types, same values as enum FTYPES of interflop.h
+enum Ftypes { FLOAT, DOUBLE, QUAD, FLOAT_PTR, DOUBLE_PTR, QUAD_PTR };
 
 // Types
 llvm::Type *FloatTy, *DoubleTy, *FloatPtrTy, *DoublePtrTy, *Int8Ty, *Int8PtrTy,
-    *Int32Ty;
+    *Int16Ty, *Int32Ty;
+
+// Type of interflop_function_info_t
+// {char *id, short isLibraryFunction, short isIntrinsicFunction,
+//  short useFloat, short useDouble, int index}
+StructType *FunctionInfoTy;
+
+// Descriptors of the instrumented functions of the module
+std::vector<Constant *> FunctionInfos;
+
+// Create the static descriptor of a function, its index is assigned at
+// runtime when the descriptors of the module are registered
+Constant *createFunctionInfo(Module &M, const std::string &id,
+                             bool isLibraryFunction, bool isIntrinsicFunction,
+                             bool useFloat, bool useDouble) {
+  Constant *str = ConstantDataArray::getString(M.getContext(), id);
+  GlobalVariable *idGV =
+      new GlobalVariable(M, str->getType(), true, GlobalValue::PrivateLinkage,
+                         str, "vfc_function_id");
+  Constant *info = ConstantStruct::get(
+      FunctionInfoTy, {ConstantExpr::getPointerCast(idGV, Int8PtrTy),
+                       ConstantInt::get(Int16Ty, isLibraryFunction),
+                       ConstantInt::get(Int16Ty, isIntrinsicFunction),
+                       ConstantInt::get(Int16Ty, useFloat),
+                       ConstantInt::get(Int16Ty, useDouble),
+                       ConstantInt::get(Int32Ty, -1)});
+  GlobalVariable *infoGV =
+      new GlobalVariable(M, FunctionInfoTy, false, GlobalValue::InternalLinkage,
+                         info, "vfc_function_info");
+  FunctionInfos.push_back(infoGV);
+  return infoGV;
+}
+
+// Register the descriptors of the module from a constructor calling
+// vfc_register_functions(interflop_function_info_t **functions, int n)
+void registerFunctionInfos(Module &M) {
+  PointerType *FunctionInfoPtrTy = PointerType::get(FunctionInfoTy, 0);
+  ArrayType *TableTy = ArrayType::get(FunctionInfoPtrTy, FunctionInfos.size());
+  GlobalVariable *Table = new GlobalVariable(
+      M, TableTy, true, GlobalValue::PrivateLinkage,
+      ConstantArray::get(TableTy, FunctionInfos), "vfc_function_table");
+
+  Type *VoidTy = Type::getVoidTy(M.getContext());
+  FunctionType *RegisterTy = FunctionType::get(
+      VoidTy, {PointerType::get(FunctionInfoPtrTy, 0), Int32Ty}, false);
+#if LLVM_VERSION_MAJOR < 9
+  Constant *Register =
+      M.getOrInsertFunction("vfc_register_functions", RegisterTy);
+#else
+  FunctionCallee Register =
+      M.getOrInsertFunction("vfc_register_functions", RegisterTy);
+#endif
+
+  Function *Ctor =
+      Function::Create(FunctionType::get(VoidTy, false),
+                       GlobalValue::InternalLinkage, "vfc_functions_init", &M);
+  IRBuilder<> Builder(BasicBlock::Create(M.getContext(), "entry", Ctor));
+  Builder.CreateCall(Register,
+                     {Builder.CreateConstInBoundsGEP2_32(TableTy, Table, 0, 0),
+                      Builder.getInt32(FunctionInfos.size())});
+  Builder.CreateRetVoid();
+  appendToGlobalCtors(M, Ctor, 65535);
+}
 
 // Array of values
-Value *Types2val[] = {NULL, NULL, NULL, NULL};
+Value *Types2val[] = {NULL, NULL, NULL, NULL, NULL, NULL};
+
+// Type of interflop_function_arg_t
+// {int type, unsigned int size, const char *name, void *value}
+StructType *FunctionArgTy;
+
+// Argument passed to vfc_enter_function or vfc_exit_function
+struct FunctionArg {
+  Ftypes type;
+  std::string name;
+  unsigned size;
+  Value *value;
+};
+
+// Lay out the arguments in an array of interflop_function_arg_t on the stack
+// and return its address
+Value *createFunctionArgs(IRBuilder<> &Builder,
+                          const std::vector<FunctionArg> &Args) {
+  if (Args.empty())
+    return ConstantPointerNull::get(PointerType::get(FunctionArgTy, 0));
+
+  Value *Array =
+      Builder.CreateAlloca(FunctionArgTy, Builder.getInt32(Args.size()));
+  for (unsigned i = 0; i < Args.size(); i++) {
+    Value *Arg = Builder.CreateConstInBoundsGEP1_32(FunctionArgTy, Array, i);
+    Builder.CreateStore(Types2val[Args[i].type],
+                        Builder.CreateStructGEP(FunctionArgTy, Arg, 0));
+    Builder.CreateStore(Builder.getInt32(Args[i].size),
+                        Builder.CreateStructGEP(FunctionArgTy, Arg, 1));
+    Builder.CreateStore(Builder.CreateGlobalStringPtr(Args[i].name),
+                        Builder.CreateStructGEP(FunctionArgTy, Arg, 2));
+    Builder.CreateStore(Builder.CreatePointerCast(Args[i].value, Int8PtrTy),
+                        Builder.CreateStructGEP(FunctionArgTy, Arg, 3));
+  }
+
+  return Array;
+}
+
+// Call site seen by the pass, written in the report file
+struct CallSiteReport {
+  // Function containing the call site
+  std::string caller;
+  // Called function
+  std::string callee;
+  // Identifier passed to vfc_enter_function
+  std::string id;
+  // Line of the call site
+  unsigned line;
+  bool isLibraryFunction;
+  bool isIntrinsicFunction;
+  bool useFloat;
+  bool useDouble;
+  // False when the call site has been left uninstrumented
+  bool instrumented;
+};
+
+std::vector<CallSiteReport> CallSiteReports;
+
+// Write the call sites report, the format is chosen from the file extension
+void writeReport(Module &M) {
+  std::ofstream out(VfclibFuncReportFile.c_str());
+  if (!out.is_open()) {
+    errs() << "Cannot open " << VfclibFuncReportFile << "\n";
+    report_fatal_error("libVFCFuncInstrument fatal error");
+  }
+
+  if (sys::path::extension(VfclibFuncReportFile) == ".csv") {
+    out << "module,caller,callee,id,line,library,intrinsic,float,double,"
+           "instrumented\n";
+    for (auto &site : CallSiteReports) {
+      out << csvEscape(M.getSourceFileName()) << ","
+          << csvEscape(site.caller) << "," << csvEscape(site.callee) << ","
+          << csvEscape(site.id) << "," << site.line << ","
+          << site.isLibraryFunction << "," << site.isIntrinsicFunction << ","
+          << site.useFloat << "," << site.useDouble << ","
+          << site.instrumented << "\n";
+    }
+  } else {
+    out << "{\n  \"module\": " << jsonEscape(M.getSourceFileName()) << ",\n"
+        << "  \"call_sites\": [";
+    bool first = true;
+    for (auto &site : CallSiteReports) {
+      out << (first ? "\n" : ",\n") << "    {\"caller\": "
+          << jsonEscape(site.caller)
+          << ", \"callee\": " << jsonEscape(site.callee)
+          << ", \"id\": " << jsonEscape(site.id)
+          << ", \"line\": " << site.line
+          << ", \"library\": " << (site.isLibraryFunction ? "true" : "false")
+          << ", \"intrinsic\": "
+          << (site.isIntrinsicFunction ? "true" : "false")
+          << ", \"float\": " << (site.useFloat ? "true" : "false")
+          << ", \"double\": " << (site.useDouble ? "true" : "false")
+          << ", \"instrumented\": " << (site.instrumented ? "true" : "false")
+          << "}";
+      first = false;
+    }
+    out << (first ? "" : "\n  ") << "]\n}\n";
+  }
+  out.close();
+}
 
 // Fill use_double and use_float with true if the call_inst pi use at least
 // of the managed types
@@ -186,6 +384,108 @@ std::string getArgName(Function *F, unsigned int i) {
   return "parameter_" + std::to_string(i + 1);
 }
 
+// Test if a call has float or double arguments or return value, scalar or
+// pointer, which would be passed to vfc_enter_function or vfc_exit_function
+bool haveFloatingPointArguments(const CallInst *call) {
+  Type *ReturnTy = call->getType();
+  if (ReturnTy == FloatTy || ReturnTy == DoubleTy || ReturnTy == FloatPtrTy ||
+      ReturnTy == DoublePtrTy)
+    return true;
+
+  for (auto it = call->op_begin(); it < call->op_end() - 1; it++) {
+    Type *opType = cast<Value>(it)->getType();
+    if (opType == FloatTy || opType == DoubleTy || opType == FloatPtrTy ||
+        opType == DoublePtrTy)
+      return true;
+  }
+
+  return false;
+}
+
+// Number of instructions of a function
+size_t countInstructions(const Function *F) {
+  size_t n = 0;
+  for (auto &B : *F)
+    n += B.size();
+  return n;
+}
+
+// Test if a function has no loop and only calls intrinsics
+bool isLoopFreeLeaf(const Function *F) {
+  for (auto &B : *F) {
+    for (auto &I : B) {
+      if ((isa<CallInst>(I) && !isa<IntrinsicInst>(I)) || isa<InvokeInst>(I))
+        return false;
+    }
+  }
+
+  SmallVector<std::pair<const BasicBlock *, const BasicBlock *>, 8> BackEdges;
+  FindFunctionBackedges(*F, BackEdges);
+  return BackEdges.empty();
+}
+
+// Compute the call depth of the functions of the module, starting from the
+// functions which are not called in the module
+std::map<const Function *, unsigned> computeCallDepths(Module &M) {
+  std::map<const Function *, std::vector<const Function *>> Callees;
+  std::set<const Function *> Called;
+
+  for (auto &F : M) {
+    for (auto &B : F) {
+      for (auto &I : B) {
+        if (const CallInst *call = dyn_cast<CallInst>(&I)) {
+          const Function *f = call->getCalledFunction();
+          if (f != NULL && f != &F && f->size() != 0) {
+            Callees[&F].push_back(f);
+            Called.insert(f);
+          }
+        }
+      }
+    }
+  }
+
+  std::map<const Function *, unsigned> Depths;
+  std::vector<const Function *> Queue;
+  for (auto &F : M) {
+    if (F.size() != 0 && Called.count(&F) == 0) {
+      Depths[&F] = 0;
+      Queue.push_back(&F);
+    }
+  }
+
+  for (size_t i = 0; i < Queue.size(); i++) {
+    for (const Function *f : Callees[Queue[i]]) {
+      if (Depths.count(f) == 0) {
+        Depths[f] = Depths[Queue[i]] + 1;
+        Queue.push_back(f);
+      }
+    }
+  }
+
+  return Depths;
+}
+
+// Test if a call is left uninstrumented by the filtering options, the
+// called function is then attributed to its caller
+bool isFilteredCall(const CallInst *call, const Function *f, unsigned depth) {
+  if (VfclibFuncMaxDepth != 0 && depth > VfclibFuncMaxDepth)
+    return true;
+
+  if (VfclibFuncSkipNoFPArgs && !haveFloatingPointArguments(call))
+    return true;
+
+  // Size and loops are only known for the functions defined in the module
+  if (f->size() != 0) {
+    if (countInstructions(f) < VfclibFuncMinInstructions)
+      return true;
+
+    if (VfclibFuncSkipLeaf && isLoopFreeLeaf(f))
+      return true;
+  }
+
+  return false;
+}
+
 void InstrumentFunction(std::vector<Value *> MetaData,
                         Function *CurrentFunction, Function *HookedFunction,
                         const CallInst *call, BasicBlock *B, Module &M) {
@@ -228,52 +528,36 @@ void InstrumentFunction(std::vector<Value *> MetaData,
     }
   }
 
-  std::vector<Value *> InputMetaData = MetaData;
-  InputMetaData.push_back(ConstantInt::get(Builder.getInt32Ty(), input_cpt));
-
-  std::vector<Value *> OutputMetaData = MetaData;
-  OutputMetaData.push_back(ConstantInt::get(Builder.getInt32Ty(), output_cpt));
-
   // Step 2: for each function input (arguments), add its type, size, name and
-  // address to the list of parameters sent to vfc_enter for processing.
-  std::vector<Value *> EnterArgs = InputMetaData;
+  // address to the array of arguments sent to vfc_enter for processing.
+  std::vector<FunctionArg> EnterArgs;
   size_t input_index = 0;
   for (auto &args : CurrentFunction->args()) {
+    std::string name = getArgName(HookedFunction, args.getArgNo());
     if (args.getType() == DoubleTy) {
-      EnterArgs.push_back(Types2val[DOUBLE]);
-      EnterArgs.push_back(Builder.CreateGlobalStringPtr(
-          getArgName(HookedFunction, args.getArgNo())));
-      EnterArgs.push_back(ConstantInt::get(Int32Ty, 1));
-      EnterArgs.push_back(InputAlloca[input_index]);
+      EnterArgs.push_back({DOUBLE, name, 1, InputAlloca[input_index]});
       Builder.CreateStore(&args, InputAlloca[input_index++]);
     } else if (args.getType() == FloatTy) {
-      EnterArgs.push_back(Types2val[FLOAT]);
-      EnterArgs.push_back(Builder.CreateGlobalStringPtr(
-          getArgName(HookedFunction, args.getArgNo())));
-      EnterArgs.push_back(ConstantInt::get(Int32Ty, 1));
-      EnterArgs.push_back(InputAlloca[input_index]);
+      EnterArgs.push_back({FLOAT, name, 1, InputAlloca[input_index]});
       Builder.CreateStore(&args, InputAlloca[input_index++]);
     } else if (args.getType() == FloatPtrTy && call) {
-      EnterArgs.push_back(Types2val[FLOAT_PTR]);
-      EnterArgs.push_back(Builder.CreateGlobalStringPtr(
-          getArgName(HookedFunction, args.getArgNo())));
-      EnterArgs.push_back(
-          ConstantInt::get(Int32Ty, getSizeOf(call->getOperand(args.getArgNo()),
-                                              call->getParent()->getParent())));
-      EnterArgs.push_back(&args);
+      EnterArgs.push_back({FLOAT_PTR, name,
+                           getSizeOf(call->getOperand(args.getArgNo()),
+                                     call->getParent()->getParent()),
+                           &args});
     } else if (args.getType() == DoublePtrTy && call) {
-      EnterArgs.push_back(Types2val[DOUBLE_PTR]);
-      EnterArgs.push_back(Builder.CreateGlobalStringPtr(
-          getArgName(HookedFunction, args.getArgNo())));
-      EnterArgs.push_back(
-          ConstantInt::get(Int32Ty, getSizeOf(call->getOperand(args.getArgNo()),
-                                              call->getParent()->getParent())));
-      EnterArgs.push_back(&args);
+      EnterArgs.push_back({DOUBLE_PTR, name,
+                           getSizeOf(call->getOperand(args.getArgNo()),
+                                     call->getParent()->getParent()),
+                           &args});
     }
   }
 
   // Step 3: call vfc_enter
-  Builder.CreateCall(func_enter, EnterArgs);
+  std::vector<Value *> EnterMetaData = MetaData;
+  EnterMetaData.push_back(ConstantInt::get(Int32Ty, input_cpt));
+  EnterMetaData.push_back(createFunctionArgs(Builder, EnterArgs));
+  Builder.CreateCall(func_enter, EnterMetaData);
 
   // Step 4: load modified values
   std::vector<Value *> FunctionArgs;
@@ -307,58 +591,44 @@ void InstrumentFunction(std::vector<Value *> MetaData,
   }
 
   // Step 6: for each function output (return value, and pointers as argument),
-  // add its type, size, name and address to the list of parameters sent to
+  // add its type, size, name and address to the array of arguments sent to
   // vfc_exit for processing.
-  std::vector<Value *> ExitArgs = OutputMetaData;
+  std::vector<FunctionArg> ExitArgs;
   if (ret->getType() == DoubleTy) {
-    ExitArgs.push_back(Types2val[DOUBLE]);
-    ExitArgs.push_back(Builder.CreateGlobalStringPtr("return_value"));
-    ExitArgs.push_back(ConstantInt::get(Int32Ty, 1));
-    ExitArgs.push_back(OutputAlloca[0]);
+    ExitArgs.push_back({DOUBLE, "return_value", 1, OutputAlloca[0]});
     Builder.CreateStore(ret, OutputAlloca[0]);
   } else if (ret->getType() == FloatTy) {
-    ExitArgs.push_back(Types2val[FLOAT]);
-    ExitArgs.push_back(Builder.CreateGlobalStringPtr("return_value"));
-    ExitArgs.push_back(ConstantInt::get(Int32Ty, 1));
-    ExitArgs.push_back(OutputAlloca[0]);
+    ExitArgs.push_back({FLOAT, "return_value", 1, OutputAlloca[0]});
     Builder.CreateStore(ret, OutputAlloca[0]);
   } else if (HookedFunction->getReturnType() == FloatPtrTy && call) {
-    ExitArgs.push_back(Types2val[FLOAT_PTR]);
-    ExitArgs.push_back(Builder.CreateGlobalStringPtr("return_value"));
-    ExitArgs.push_back(ConstantInt::get(
-        Int32Ty, getSizeOf(ret, call->getParent()->getParent())));
-    ExitArgs.push_back(ret);
+    ExitArgs.push_back({FLOAT_PTR, "return_value",
+                        getSizeOf(ret, call->getParent()->getParent()), ret});
   } else if (HookedFunction->getReturnType() == DoublePtrTy && call) {
-    ExitArgs.push_back(Types2val[DOUBLE_PTR]);
-    ExitArgs.push_back(Builder.CreateGlobalStringPtr("return_value"));
-    ExitArgs.push_back(ConstantInt::get(
-        Int32Ty, getSizeOf(ret, call->getParent()->getParent())));
-    ExitArgs.push_back(ret);
+    ExitArgs.push_back({DOUBLE_PTR, "return_value",
+                        getSizeOf(ret, call->getParent()->getParent()), ret});
   }
 
   for (auto &args : CurrentFunction->args()) {
     if (args.getType() == FloatPtrTy && call) {
-      ExitArgs.push_back(Types2val[FLOAT_PTR]);
-      ExitArgs.push_back(Builder.CreateGlobalStringPtr(
-          getArgName(HookedFunction, args.getArgNo())));
-      ExitArgs.push_back(
-          ConstantInt::get(Int32Ty, getSizeOf(call->getOperand(args.getArgNo()),
-                                              call->getParent()->getParent())));
-      ExitArgs.push_back(&args);
+      ExitArgs.push_back({FLOAT_PTR,
+                          getArgName(HookedFunction, args.getArgNo()),
+                          getSizeOf(call->getOperand(args.getArgNo()),
+                                    call->getParent()->getParent()),
+                          &args});
     } else if (args.getType() == DoublePtrTy && call) {
-      ExitArgs.push_back(Types2val[DOUBLE_PTR]);
-      ExitArgs.push_back(Builder.CreateGlobalStringPtr(
-          getArgName(HookedFunction, args.getArgNo())));
-      ExitArgs.push_back(
-          ConstantInt::get(Type::getInt32Ty(M.getContext()),
-                           getSizeOf(call->getOperand(args.getArgNo()),
-                                     call->getParent()->getParent())));
-      ExitArgs.push_back(&args);
+      ExitArgs.push_back({DOUBLE_PTR,
+                          getArgName(HookedFunction, args.getArgNo()),
+                          getSizeOf(call->getOperand(args.getArgNo()),
+                                    call->getParent()->getParent()),
+                          &args});
     }
   }
 
   // Step 7: call vfc_exit
-  Builder.CreateCall(func_exit, ExitArgs);
+  std::vector<Value *> ExitMetaData = MetaData;
+  ExitMetaData.push_back(ConstantInt::get(Int32Ty, output_cpt));
+  ExitMetaData.push_back(createFunctionArgs(Builder, ExitArgs));
+  Builder.CreateCall(func_exit, ExitMetaData);
 
   // Step 8: load the modified return value
   if (ret->getType() == DoubleTy) {
@@ -397,12 +667,20 @@ struct VfclibFunc : public ModulePass {
     DoublePtrTy = Type::getDoublePtrTy(M.getContext());
     Int8Ty = Type::getInt8Ty(M.getContext());
     Int8PtrTy = Type::getInt8PtrTy(M.getContext());
+    Int16Ty = Type::getInt16Ty(M.getContext());
     Int32Ty = Type::getInt32Ty(M.getContext());
+    FunctionInfoTy = StructType::create(
+        {Int8PtrTy, Int16Ty, Int16Ty, Int16Ty, Int16Ty, Int32Ty},
+        "struct.interflop_function_info");
+
+    for (int type = FLOAT; type <= QUAD_PTR; type++)
+      Types2val[type] = ConstantInt::get(Int32Ty, type);
 
-    Types2val[0] = ConstantInt::get(Int32Ty, 0);
-    Types2val[1] = ConstantInt::get(Int32Ty, 1);
-    Types2val[2] = ConstantInt::get(Int32Ty, 2);
-    Types2val[3] = ConstantInt::get(Int32Ty, 3);
+    // Call depths are computed before main is cloned, the clone of main has
+    // no entry and gets the depth 0 of main
+    std::map<const Function *, unsigned> Depths;
+    if (VfclibFuncMaxDepth != 0)
+      Depths = computeCallDepths(M);
 
     /*************************************************************************
      *                  Get original functions's names                       *
@@ -417,19 +695,24 @@ struct VfclibFunc : public ModulePass {
      *                  Enter and exit functions declarations                *
      *************************************************************************/
 
-    std::vector<Type *> ArgTypes{Int8PtrTy, Int8Ty, Int8Ty,
-                                 Int8Ty,    Int8Ty, Int32Ty};
+    FunctionArgTy = StructType::create({Int32Ty, Int32Ty, Int8PtrTy, Int8PtrTy},
+                                       "struct.interflop_function_arg");
+
+    std::vector<Type *> ArgTypes{PointerType::get(FunctionInfoTy, 0), Int32Ty,
+                                 PointerType::get(FunctionArgTy, 0)};
 
     // Signature of enter_function and exit_function
     FunctionType *FunTy =
-        FunctionType::get(Type::getVoidTy(M.getContext()), ArgTypes, true);
+        FunctionType::get(Type::getVoidTy(M.getContext()), ArgTypes, false);
 
-    // void vfc_enter_function (char*, char, char, char, char, int, ...)
+    // void vfc_enter_function (interflop_function_info_t*, int,
+    //                          interflop_function_arg_t*)
     func_enter = Function::Create(FunTy, Function::ExternalLinkage,
                                   "vfc_enter_function", &M);
     func_enter->setCallingConv(CallingConv::C);
 
-    // void vfc_exit_function (char*, char, char, char, char, int, ...)
+    // void vfc_exit_function (interflop_function_info_t*, int,
+    //                         interflop_function_arg_t*)
     func_exit = Function::Create(FunTy, Function::ExternalLinkage,
                                  "vfc_exit_function", &M);
     func_exit->setCallingConv(CallingConv::C);
@@ -463,24 +746,20 @@ struct VfclibFunc : public ModulePass {
       BasicBlock *block = BasicBlock::Create(M.getContext(), "block", Main);
       IRBuilder<> Builder(block);
 
-      // Create function ID
-      Value *FunctionID = Builder.CreateGlobalStringPtr(FunctionName);
-
-      // Constants creation
-      Constant *isLibraryFunction = ConstantInt::get(Int8Ty, 0);
-      Constant *isInstrinsicFunction = ConstantInt::get(Int8Ty, 0);
-      Constant *haveFloat = ConstantInt::get(Int8Ty, use_float);
-      Constant *haveDouble = ConstantInt::get(Int8Ty, use_double);
+      // Create the function descriptor
+      Constant *FunctionInfo = createFunctionInfo(M, FunctionName, false,
+                                                  false, use_float, use_double);
 
       // Enter metadata arguments
-      std::vector<Value *> MetaData{FunctionID, isLibraryFunction,
-                                    isInstrinsicFunction, haveFloat,
-                                    haveDouble};
+      std::vector<Value *> MetaData{FunctionInfo};
 
       Clone->setName(NewName);
 
       InstrumentFunction(MetaData, Main, Clone, NULL, block, M);
 
+      CallSiteReports.push_back({"", Name, FunctionName, Sub->getLine(), false,
+                                 false, use_float, use_double, true});
+
       OriginalFunctions.push_back(Clone);
     }
 
@@ -535,28 +814,34 @@ struct VfclibFunc : public ModulePass {
                   bool use_float, use_double;
                   haveFloatingPointArithmetic(pi, f, &use_float, &use_double);
 
+                  CallSiteReports.push_back(
+                      {Parent, Name, FunctionName, line, is_from_library,
+                       is_intrinsic, use_float, use_double, true});
+
                   // If the called function is an intrinsic function that does
                   // not use float or double, do not instrument it.
                   if (is_intrinsic && !(use_float || use_double)) {
+                    CallSiteReports.back().instrumented = false;
                     continue;
                   }
 
-                  // Create function ID
-                  Value *FunctionID =
-                      Builder.CreateGlobalStringPtr(FunctionName);
+                  // Do not instrument the calls excluded by the filtering
+                  // options, a call is one level deeper than its caller
+                  auto depth = Depths.find(F);
+                  if (isFilteredCall(cast<CallInst>(pi), f,
+                                     (depth != Depths.end()) ? depth->second + 1
+                                                             : 1)) {
+                    CallSiteReports.back().instrumented = false;
+                    continue;
+                  }
 
-                  // Constants creation
-                  Constant *isLibraryFunction =
-                      ConstantInt::get(Int8Ty, is_from_library);
-                  Constant *isInstrinsicFunction =
-                      ConstantInt::get(Int8Ty, is_intrinsic);
-                  Constant *haveFloat = ConstantInt::get(Int8Ty, use_float);
-                  Constant *haveDouble = ConstantInt::get(Int8Ty, use_double);
+                  // Create the function descriptor
+                  Constant *FunctionInfo =
+                      createFunctionInfo(M, FunctionName, is_from_library,
+                                         is_intrinsic, use_float, use_double);
 
                   // Enter function arguments
-                  std::vector<Value *> MetaData{FunctionID, isLibraryFunction,
-                                                isInstrinsicFunction, haveFloat,
-                                                haveDouble};
+                  std::vector<Value *> MetaData{FunctionInfo};
 
                   Type *ReturnTy = f->getReturnType();
                   std::vector<Type *> CallTypes;
@@ -592,6 +877,14 @@ struct VfclibFunc : public ModulePass {
       }
     }
 
+    if (not FunctionInfos.empty()) {
+      registerFunctionInfos(M);
+    }
+
+    if (not VfclibFuncReportFile.empty()) {
+      writeReport(M);
+    }
+
     return true;
   }
 }; // namespace
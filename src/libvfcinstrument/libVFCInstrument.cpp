@@ -18,6 +18,7 @@
  *                                                                           *\
  ****************************************************************************/
 #include "../../config.h"
+#include "../common/vfc_report.h"
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #include "llvm/IR/IRBuilder.h"
@@ -26,19 +27,24 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/ModuleUtils.h"
 #include <llvm/IRReader/IRReader.h>
 #include <llvm/Support/SourceMgr.h>
 #pragma GCC diagnostic pop
 
+#include <algorithm>
 #include <cxxabi.h>
 #include <fstream>
 #include <functional>
+#include <map>
 #include <regex>
 #include <set>
 #include <sstream>
+#include <tuple>
 #include <utility>
 
 #if LLVM_VERSION_MAJOR < 11
@@ -79,6 +85,34 @@ static cl::opt<bool>
                              cl::desc("Instrument floating point comparisons"),
                              cl::value_desc("InstrumentFCMP"), cl::init(false));
 
+static cl::opt<std::string> VfclibInstReportFile(
+    "vfclibinst-report-file",
+    cl::desc("Write an instrumentation report in ReportFile (.json or .csv)"),
+    cl::value_desc("ReportFile"), cl::init(""));
+
+static cl::opt<bool> VfclibInstProfileGen(
+    "vfclibinst-profile-gen",
+    cl::desc("Count the executions of each floating point operation site "
+             "instead of instrumenting it"),
+    cl::value_desc("ProfileGen"), cl::init(false));
+
+static cl::opt<std::string> VfclibInstProfile(
+    "vfclibinst-profile",
+    cl::desc("Select the instrumented sites from the site profile ProfileFile"),
+    cl::value_desc("ProfileFile"), cl::init(""));
+
+static cl::opt<double> VfclibInstProfileCoverage(
+    "vfclibinst-profile-coverage",
+    cl::desc("Only instrument the hottest sites covering Coverage% of the "
+             "profiled operations"),
+    cl::value_desc("Coverage"), cl::init(100.0));
+
+static cl::opt<uint64_t> VfclibInstProfileThreshold(
+    "vfclibinst-profile-threshold",
+    cl::desc("Only instrument the sites executed at most Threshold times "
+             "(0 means no threshold)"),
+    cl::value_desc("Threshold"), cl::init(0));
+
 /* pointer that hold the vfcwrapper Module */
 static Module *vfcwrapperM = nullptr;
 
@@ -98,6 +132,27 @@ std::map<Type::TypeID, std::string> validTypesMap = {
 /* valid vector sizes to instrument */
 const std::set<unsigned> validVectorSizes = {2, 4, 8, 16};
 
+/* Instrumentation statistics of a function, written in the report file */
+struct FunctionReport {
+  // How the function was selected: include, exclude, not-included or default
+  std::string selection;
+  // Include/exclude rule that matched the function, if any
+  std::string rule;
+  // Number of instrumented operations per (operation, type, width)
+  std::map<std::tuple<std::string, std::string, unsigned>, unsigned>
+      instrumented;
+  // Number of skipped operations per (operation, type, width, reason)
+  std::map<std::tuple<std::string, std::string, unsigned, std::string>,
+           unsigned>
+      skipped;
+  // Number of floating point operations left native because the function is
+  // not selected for instrumentation
+  unsigned native = 0;
+};
+
+/* An include/exclude rule: its textual description and function regex */
+typedef std::pair<std::string, std::regex> FunctionRule;
+
 struct VfclibInst : public ModulePass {
   static char ID;
 
@@ -152,7 +207,8 @@ struct VfclibInst : public ModulePass {
     }
   }
 
-  std::regex parseFunctionSetFile(Module &M, cl::opt<std::string> &fileName) {
+  std::regex parseFunctionSetFile(Module &M, cl::opt<std::string> &fileName,
+                                  std::vector<FunctionRule> *rules = nullptr) {
     // Skip if empty fileName
     if (fileName.empty()) {
       return std::regex("");
@@ -210,6 +266,12 @@ struct VfclibInst : public ModulePass {
 
         if (std::regex_match(moduleName, std::regex(mod))) {
           moduleRegex += fun + "|";
+          if (rules) {
+            rules->push_back(FunctionRule(fileName + ":" +
+                                              std::to_string(lineno) + ": " +
+                                              l.trim().str(),
+                                          std::regex(fun)));
+          }
         }
       }
     }
@@ -222,6 +284,64 @@ struct VfclibInst : public ModulePass {
     return std::regex(moduleRegex);
   }
 
+  /* Parse the site profile file and select the sites to instrument */
+  /* Each line of the profile is "<module> <function> <site> <count>" */
+  void parseProfileFile() {
+    std::ifstream stream(VfclibInstProfile.c_str());
+    if (!stream.is_open()) {
+      errs() << "Cannot open " << VfclibInstProfile << "\n";
+      report_fatal_error("libVFCInstrument fatal error");
+    }
+
+    // Sum the counts of sites that appear several times
+    std::map<std::string, uint64_t> counts;
+    uint64_t total = 0;
+    int lineno = 0;
+    std::string line;
+    while (std::getline(stream, line)) {
+      lineno++;
+      StringRef l = StringRef(line).trim();
+
+      // Ignore empty or commented lines
+      if (l.startswith("#") || l.empty()) {
+        continue;
+      }
+      std::pair<StringRef, StringRef> p = l.rsplit(" ");
+      uint64_t count;
+      if (p.second.empty() || p.second.getAsInteger(10, count)) {
+        errs() << "Syntax error in profile file " << VfclibInstProfile << ":"
+               << lineno << "\n";
+        report_fatal_error("libVFCInstrument fatal error");
+      }
+      counts[p.first.trim().str()] += count;
+      total += count;
+    }
+    stream.close();
+
+    // Sort sites by decreasing count to select the hottest ones
+    std::vector<std::pair<uint64_t, std::string>> sites;
+    for (auto &c : counts) {
+      sites.push_back(std::make_pair(c.second, c.first));
+    }
+    std::stable_sort(sites.begin(), sites.end(),
+                     [](const std::pair<uint64_t, std::string> &a,
+                        const std::pair<uint64_t, std::string> &b) {
+                       return a.first > b.first;
+                     });
+
+    // Coverage pass: keep the hottest sites until the budget is covered
+    double budget = total * VfclibInstProfileCoverage / 100.0;
+    uint64_t covered = 0;
+    for (auto &site : sites) {
+      if (site.first == 0 || covered >= budget) {
+        break;
+      }
+      covered += site.first;
+      ProfileCoveredSites.insert(site.second);
+    }
+    ProfileCounts = counts;
+  }
+
   /* Load vfcwrapper.ll Module */
   void loadVfcwrapperIR(Module &M) {
     SMDiagnostic err;
@@ -239,20 +359,29 @@ struct VfclibInst : public ModulePass {
 
     loadVfcwrapperIR(M);
 
+    // Rules are only kept when a report is requested
+    std::vector<FunctionRule> includeRules, excludeRules;
+    bool report = not VfclibInstReportFile.empty();
+
     // Parse both included and excluded function set
-    std::regex includeFunctionRgx =
-        parseFunctionSetFile(M, VfclibInstIncludeFile);
-    std::regex excludeFunctionRgx =
-        parseFunctionSetFile(M, VfclibInstExcludeFile);
+    std::regex includeFunctionRgx = parseFunctionSetFile(
+        M, VfclibInstIncludeFile, report ? &includeRules : nullptr);
+    std::regex excludeFunctionRgx = parseFunctionSetFile(
+        M, VfclibInstExcludeFile, report ? &excludeRules : nullptr);
 
     // Parse instrument single function option (--function)
     if (not VfclibInstFunction.empty()) {
       includeFunctionRgx = std::regex(VfclibInstFunction);
       excludeFunctionRgx = std::regex(".*");
+      includeRules = {FunctionRule("--function " + VfclibInstFunction,
+                                   includeFunctionRgx)};
+      excludeRules = {FunctionRule("--function " + VfclibInstFunction,
+                                   excludeFunctionRgx)};
     }
 
     // Find the list of functions to instrument
     std::vector<Function *> functions;
+    std::vector<Function *> ignoredFunctions;
     for (auto &F : M.functions()) {
 
       const std::string &name = F.getName().str();
@@ -260,30 +389,351 @@ struct VfclibInst : public ModulePass {
       // Included-list
       if (std::regex_match(name, includeFunctionRgx)) {
         functions.push_back(&F);
+        if (report)
+          setFunctionSelection(F, "include", includeRules);
         continue;
       }
 
       // Excluded-list
       if (std::regex_match(name, excludeFunctionRgx)) {
+        ignoredFunctions.push_back(&F);
+        if (report)
+          setFunctionSelection(F, "exclude", excludeRules);
         continue;
       }
 
       // If excluded-list is empty and included-list is not, we are done
       if (VfclibInstExcludeFile.empty() and not VfclibInstIncludeFile.empty()) {
+        ignoredFunctions.push_back(&F);
+        if (report)
+          setFunctionSelection(F, "not-included", {});
         continue;
       } else {
         // Everything else is neither include-listed or exclude-listed
         functions.push_back(&F);
+        if (report)
+          setFunctionSelection(F, "default", {});
       }
     }
+    // Number the operation sites of the selected functions
+    if (VfclibInstProfileGen or not VfclibInstProfile.empty()) {
+      if (not VfclibInstProfile.empty())
+        parseProfileFile();
+      numberSites(M, functions);
+    }
+
     // Do the instrumentation on selected functions
     for (auto F : functions) {
       modified |= runOnFunction(M, *F);
     }
+
+    if (VfclibInstProfileGen and not SiteNames.empty()) {
+      insertSiteProfileDump(M);
+      modified = true;
+    }
+
+    if (report) {
+      // Count the operations that are left native
+      for (auto F : ignoredFunctions) {
+        for (auto &B : *F) {
+          for (auto &I : B) {
+            if (mustReplace(I) != FOP_IGNORE)
+              Reports[F].native++;
+          }
+        }
+      }
+      writeReport(M);
+    }
+
+    if (VfclibInstVerbose)
+      printVectorWidths();
+
     // runOnModule must return true if the pass modifies the IR
     return modified;
   }
 
+  /************************************************************
+   *                      Site profiling                      *
+   ************************************************************/
+
+  // Name of each operation site of the module, "<module> <function> <site>"
+  std::vector<std::string> SiteNames;
+
+  // Index of each operation site in SiteNames
+  std::map<Instruction *, unsigned> SiteIds;
+
+  // Sites selected for instrumentation by the profile
+  std::set<std::string> ProfileCoveredSites;
+  std::map<std::string, uint64_t> ProfileCounts;
+
+  // Execution counters of the sites, with --vfclibinst-profile-gen
+  GlobalVariable *SiteCounters = nullptr;
+
+  // Sites are numbered in IR order inside each function so that the
+  // profiling and the instrumented builds agree on their names
+  void numberSites(Module &M, const std::vector<Function *> &functions) {
+    std::string moduleName = getSourceFileNameAbsPath(M);
+    moduleName = (moduleName.empty()) ? M.getModuleIdentifier() : moduleName;
+
+    for (auto F : functions) {
+      unsigned site = 0;
+      for (auto &B : *F) {
+        for (auto &I : B) {
+          if (mustReplace(I) == FOP_IGNORE)
+            continue;
+          SiteIds[&I] = SiteNames.size();
+          SiteNames.push_back(moduleName + " " + F->getName().str() + " " +
+                              std::to_string(site++));
+        }
+      }
+    }
+
+    if (VfclibInstProfileGen and not SiteNames.empty()) {
+      ArrayType *countersTy =
+          ArrayType::get(Type::getInt64Ty(M.getContext()), SiteNames.size());
+      SiteCounters = new GlobalVariable(
+          M, countersTy, false, GlobalValue::InternalLinkage,
+          ConstantAggregateZero::get(countersTy), "vfc_site_counters");
+    }
+  }
+
+  // Returns true if the site of I must be instrumented
+  bool isSelectedByProfile(Instruction *I) {
+    if (VfclibInstProfile.empty())
+      return true;
+    const std::string &site = SiteNames[SiteIds[I]];
+    if (VfclibInstProfileThreshold == 0)
+      return ProfileCoveredSites.count(site) != 0;
+
+    // Threshold pass: the sites missing from the profile were never executed
+    auto it = ProfileCounts.find(site);
+    uint64_t count = (it == ProfileCounts.end()) ? 0 : it->second;
+    if (count > VfclibInstProfileThreshold)
+      return false;
+    // Only restrict to the covered sites when a coverage was asked for
+    return VfclibInstProfileCoverage >= 100.0 ||
+           ProfileCoveredSites.count(site) != 0;
+  }
+
+  // Atomically increment the execution counter of the site of I, so that
+  // multithreaded programs do not lose counts
+  void insertSiteCounter(Instruction *I) {
+    IRBuilder<> Builder(I);
+    Value *counter = Builder.CreateConstInBoundsGEP2_32(
+        SiteCounters->getValueType(), SiteCounters, 0, SiteIds[I]);
+#if LLVM_VERSION_MAJOR >= 13
+    Builder.CreateAtomicRMW(AtomicRMWInst::Add, counter, Builder.getInt64(1),
+                            MaybeAlign(8), AtomicOrdering::Monotonic);
+#else
+    Builder.CreateAtomicRMW(AtomicRMWInst::Add, counter, Builder.getInt64(1),
+                            AtomicOrdering::Monotonic);
+#endif
+  }
+
+  // Register a destructor that dumps the site counters at exit with
+  // vfc_site_profile_dump(const char **sites, uint64_t *counts, int n)
+  void insertSiteProfileDump(Module &M) {
+    LLVMContext &Ctx = M.getContext();
+    Type *Int8PtrTy = Type::getInt8PtrTy(Ctx);
+
+    std::vector<Constant *> names;
+    for (auto &name : SiteNames) {
+      Constant *str = ConstantDataArray::getString(Ctx, name);
+      GlobalVariable *GV =
+          new GlobalVariable(M, str->getType(), true,
+                             GlobalValue::PrivateLinkage, str, "vfc_site");
+      names.push_back(ConstantExpr::getPointerCast(GV, Int8PtrTy));
+    }
+    ArrayType *namesTy = ArrayType::get(Int8PtrTy, names.size());
+    GlobalVariable *namesGV = new GlobalVariable(
+        M, namesTy, true, GlobalValue::PrivateLinkage,
+        ConstantArray::get(namesTy, names), "vfc_site_names");
+
+    Type *VoidTy = Type::getVoidTy(Ctx);
+    FunctionType *dumpTy = FunctionType::get(
+        VoidTy,
+        {PointerType::get(Int8PtrTy, 0),
+         PointerType::get(Type::getInt64Ty(Ctx), 0), Type::getInt32Ty(Ctx)},
+        false);
+#if LLVM_VERSION_MAJOR < 9
+    Constant *dump = M.getOrInsertFunction("vfc_site_profile_dump", dumpTy);
+#else
+    FunctionCallee dump =
+        M.getOrInsertFunction("vfc_site_profile_dump", dumpTy);
+#endif
+
+    Function *dtor =
+        Function::Create(FunctionType::get(VoidTy, false),
+                         GlobalValue::InternalLinkage, "vfc_site_profile", &M);
+    IRBuilder<> Builder(BasicBlock::Create(Ctx, "entry", dtor));
+    Builder.CreateCall(
+        dump, {Builder.CreateConstInBoundsGEP2_32(namesTy, namesGV, 0, 0),
+               Builder.CreateConstInBoundsGEP2_32(SiteCounters->getValueType(),
+                                                  SiteCounters, 0, 0),
+               Builder.getInt32(SiteNames.size())});
+    Builder.CreateRetVoid();
+    appendToGlobalDtors(M, dtor, 0);
+  }
+
+  /************************************************************
+   *                  Instrumentation report                  *
+   ************************************************************/
+
+  // Report of each defined function of the module, in module order
+  std::map<Function *, FunctionReport> Reports;
+
+  // Number of instrumented operations for each vector width
+  std::map<unsigned, unsigned> VectorWidths;
+
+  // Print the distribution of the instrumented vector widths
+  void printVectorWidths() {
+    unsigned total = 0;
+    for (auto &w : VectorWidths)
+      total += w.second;
+    errs() << "Instrumented operations by vector width:\n";
+    for (auto &w : VectorWidths) {
+      errs() << "  " << w.first << ": " << w.second << " ("
+             << format("%.1f", 100.0 * w.second / total) << "%)\n";
+    }
+  }
+
+  // Record how F has been selected and the first rule that matches it
+  void setFunctionSelection(Function &F, const std::string &selection,
+                            const std::vector<FunctionRule> &rules) {
+    if (F.isDeclaration())
+      return;
+    FunctionReport &report = Reports[&F];
+    report.selection = selection;
+    for (auto &rule : rules) {
+      if (std::regex_match(F.getName().str(), rule.second)) {
+        report.rule = rule.first;
+        break;
+      }
+    }
+  }
+
+  // Record an instrumented or skipped operation of type opType
+  void reportOperation(Instruction *I, Fops opCode, const std::string &reason) {
+    Type *opType = I->getOperand(0)->getType();
+    unsigned width = getVectorWidth(opType);
+    if (reason.empty())
+      VectorWidths[width]++;
+    if (VfclibInstReportFile.empty())
+      return;
+    FunctionReport &report = Reports[I->getFunction()];
+    if (reason.empty()) {
+      const std::string &type =
+          validTypesMap[opType->getScalarType()->getTypeID()];
+      report.instrumented[std::make_tuple(Fops2str[opCode], type, width)]++;
+    } else {
+      std::string type;
+      raw_string_ostream os(type);
+      os << *opType->getScalarType();
+      os.flush();
+      report.skipped[std::make_tuple(Fops2str[opCode], type, width, reason)]++;
+    }
+  }
+
+  void writeReportJSON(Module &M, std::ofstream &out) {
+    out << "{\n  \"module\": " << jsonEscape(getModuleName(M)) << ",\n"
+        << "  \"functions\": [";
+    bool firstFunction = true;
+    for (auto &F : M.functions()) {
+      auto it = Reports.find(&F);
+      if (it == Reports.end())
+        continue;
+      FunctionReport &report = it->second;
+      out << (firstFunction ? "\n" : ",\n") << "    {\n"
+          << "      \"name\": " << jsonEscape(F.getName().str()) << ",\n"
+          << "      \"selection\": " << jsonEscape(report.selection) << ",\n"
+          << "      \"rule\": " << jsonEscape(report.rule) << ",\n"
+          << "      \"native\": " << report.native << ",\n"
+          << "      \"instrumented\": [";
+      bool first = true;
+      for (auto &op : report.instrumented) {
+        out << (first ? "\n" : ",\n") << "        {\"op\": "
+            << jsonEscape(std::get<0>(op.first))
+            << ", \"type\": " << jsonEscape(std::get<1>(op.first))
+            << ", \"width\": " << std::get<2>(op.first)
+            << ", \"count\": " << op.second << "}";
+        first = false;
+      }
+      out << (first ? "" : "\n      ") << "],\n      \"skipped\": [";
+      first = true;
+      for (auto &op : report.skipped) {
+        out << (first ? "\n" : ",\n") << "        {\"op\": "
+            << jsonEscape(std::get<0>(op.first))
+            << ", \"type\": " << jsonEscape(std::get<1>(op.first))
+            << ", \"width\": " << std::get<2>(op.first)
+            << ", \"reason\": " << jsonEscape(std::get<3>(op.first))
+            << ", \"count\": " << op.second << "}";
+        first = false;
+      }
+      out << (first ? "" : "\n      ") << "]\n    }";
+      firstFunction = false;
+    }
+    out << (firstFunction ? "" : "\n  ") << "]\n}\n";
+  }
+
+  void writeReportCSV(Module &M, std::ofstream &out) {
+    const std::string module = csvEscape(getModuleName(M));
+    out << "module,function,selection,rule,kind,op,type,width,reason,count\n";
+    for (auto &F : M.functions()) {
+      auto it = Reports.find(&F);
+      if (it == Reports.end())
+        continue;
+      FunctionReport &report = it->second;
+      const std::string prefix = module + "," + csvEscape(F.getName().str()) +
+                                 "," + report.selection + "," +
+                                 csvEscape(report.rule) + ",";
+      out << prefix << "native,,,,," << report.native << "\n";
+      for (auto &op : report.instrumented) {
+        out << prefix << "instrumented," << std::get<0>(op.first) << ","
+            << std::get<1>(op.first) << "," << std::get<2>(op.first) << ",,"
+            << op.second << "\n";
+      }
+      for (auto &op : report.skipped) {
+        out << prefix << "skipped," << std::get<0>(op.first) << ","
+            << csvEscape(std::get<1>(op.first)) << "," << std::get<2>(op.first)
+            << "," << std::get<3>(op.first) << "," << op.second << "\n";
+      }
+    }
+  }
+
+  /* Write the report file, the format is chosen from the file extension */
+  void writeReport(Module &M) {
+    std::ofstream out(VfclibInstReportFile.c_str());
+    if (!out.is_open()) {
+      errs() << "Cannot open " << VfclibInstReportFile << "\n";
+      report_fatal_error("libVFCInstrument fatal error");
+    }
+    if (sys::path::extension(VfclibInstReportFile) == ".csv") {
+      writeReportCSV(M, out);
+    } else {
+      writeReportJSON(M, out);
+    }
+    out.close();
+  }
+
+  std::string getModuleName(Module &M) {
+    std::string moduleName = getSourceFileNameAbsPath(M);
+    return (moduleName.empty()) ? M.getModuleIdentifier() : moduleName;
+  }
+
+  /* Returns the number of elements of a vector type, 1 for scalars */
+  unsigned getVectorWidth(Type *opType) {
+    if (VectorType *vecType = dyn_cast<VectorType>(opType)) {
+#if LLVM_VERSION_MAJOR >= 13
+      if (isa<ScalableVectorType>(vecType))
+        report_fatal_error("Scalable vector type are not supported");
+      return ((::llvm::FixedVectorType *)vecType)->getNumElements();
+#else
+      return vecType->getNumElements();
+#endif
+    }
+    return 1;
+  }
+
   /* Constructs the mca function name */
   /* it is built as: */
   /*  _ <size>x<type><operation> for vector */
@@ -311,17 +761,18 @@ struct VfclibInst : public ModulePass {
   }
 
   /* Check if Instruction I is a valid instruction to replace; scalar case */
-  bool isValidScalarInstruction(Type *opType) {
+  bool isValidScalarInstruction(Type *opType, std::string &reason) {
     bool isValidType =
         validTypesMap.find(opType->getTypeID()) != validTypesMap.end();
     if (not isValidType) {
       errs() << "Unsupported operand type: " << *opType << "\n";
+      reason = "unsupported type";
     }
     return isValidType;
   }
 
   /* Check if Instruction I is a valid instruction to replace; vector case */
-  bool isValidVectorInstruction(Type *opType) {
+  bool isValidVectorInstruction(Type *opType, std::string &reason) {
     VectorType *vecType = static_cast<VectorType *>(opType);
     auto baseType = vecType->getScalarType();
 #if LLVM_VERSION_MAJOR >= 13
@@ -334,18 +785,20 @@ struct VfclibInst : public ModulePass {
     bool isValidSize = validVectorSizes.find(size) != validVectorSizes.end();
     if (not isValidSize) {
       errs() << "Unsuported vector size: " << size << "\n";
+      reason = "unsupported vector size";
       return false;
     }
-    return isValidScalarInstruction(baseType);
+    return isValidScalarInstruction(baseType, reason);
   }
 
   /* Check if Instruction I is a valid instruction to replace */
-  bool isValidInstruction(Instruction *I) {
+  /* On failure, reason is set to the cause of the rejection */
+  bool isValidInstruction(Instruction *I, std::string &reason) {
     Type *opType = I->getOperand(0)->getType();
     if (opType->isVectorTy()) {
-      return isValidVectorInstruction(opType);
+      return isValidVectorInstruction(opType, reason);
     } else {
-      return isValidScalarInstruction(opType);
+      return isValidScalarInstruction(opType, reason);
     }
   }
 
@@ -493,10 +946,26 @@ struct VfclibInst : public ModulePass {
   }
 
   Value *replaceWithMCACall(Module &M, Instruction *I, Fops opCode) {
-    if (not isValidInstruction(I)) {
+    std::string reason;
+    if (not isValidInstruction(I, reason)) {
+      reportOperation(I, opCode, reason);
       return nullptr;
     }
 
+    // Profiling builds only count the executions of the site
+    if (VfclibInstProfileGen) {
+      insertSiteCounter(I);
+      reportOperation(I, opCode, "profiled");
+      return nullptr;
+    }
+
+    if (not isSelectedByProfile(I)) {
+      reportOperation(I, opCode, "not selected by profile");
+      return nullptr;
+    }
+
+    reportOperation(I, opCode, "");
+
     IRBuilder<> Builder(I);
     Type *opType = I->getOperand(0)->getType();
 
@@ -17,84 +17,142 @@
  *     Verificarlo Contributors                                              *\
  *                                                                           *\
  ****************************************************************************/
-#define _VFC_CALL_STACK_MAXSIZE 4096
+#define _VFC_CALL_STACK_INITIAL_SIZE 64
 
 /************************************************************
- *                       Hash Functions                     *
+ *                    Function descriptors                  *
  ************************************************************/
-vfc_hashmap_t _vfc_func_map;
-
-// Add a function in the hash table
-interflop_function_info_t *
-vfc_func_table_add(interflop_function_info_t function) {
-  size_t key = vfc_hashmap_str_function(function.id);
-
-  interflop_function_info_t *ptr =
-      (interflop_function_info_t *)malloc(sizeof(interflop_function_info_t));
-
-  (*ptr) = function;
-
-  vfc_hashmap_insert(_vfc_func_map, key, (void *)ptr);
+// Descriptors of the instrumented functions, indexed by their dense index.
+// Each module owns a static descriptor per call site, the function
+// instrumentation pass registers them from a constructor of the module.
+static interflop_function_info_t **_vfc_func_table = NULL;
+static int _vfc_func_table_size = 0;
+static int _vfc_func_table_capacity = 0;
+
+// Register the n function descriptors of a module and assign their index
+void vfc_register_functions(interflop_function_info_t **functions, int n) {
+  if (_vfc_func_table_size + n > _vfc_func_table_capacity) {
+    int capacity =
+        (_vfc_func_table_capacity == 0) ? 64 : 2 * _vfc_func_table_capacity;
+    while (capacity < _vfc_func_table_size + n)
+      capacity *= 2;
+
+    _vfc_func_table = (interflop_function_info_t **)realloc(
+        _vfc_func_table, capacity * sizeof(interflop_function_info_t *));
+    if (_vfc_func_table == NULL)
+      logger_error("Cannot allocate the function table\n");
+
+    _vfc_func_table_capacity = capacity;
+  }
 
-  return ptr;
+  for (int i = 0; i < n; i++) {
+    functions[i]->index = _vfc_func_table_size;
+    _vfc_func_table[_vfc_func_table_size++] = functions[i];
+  }
 }
 
-// Search a function in the hash table
-interflop_function_info_t *vfc_func_table_get(const char *id) {
-  size_t key = vfc_hashmap_str_function(id);
+// Search a function in the table
+interflop_function_info_t *vfc_func_table_get(int index) {
+  if (index < 0 || index >= _vfc_func_table_size)
+    return NULL;
 
-  return vfc_hashmap_get(_vfc_func_map, key);
+  return _vfc_func_table[index];
 }
 
 // Print the table
 void _vfc_func_table_print(FILE *f) {
-  for (size_t ii = 0; ii < _vfc_func_map->capacity; ii++) {
-    if (get_value_at(_vfc_func_map->items, ii) != 0 &&
-        get_value_at(_vfc_func_map->items, ii) != 0) {
-      interflop_function_info_t *function =
-          (interflop_function_info_t *)get_value_at(_vfc_func_map->items, ii);
-      fprintf(f, "%s\t%hd\t%hd\t%hu\t%hu\n", function->id,
-              function->isLibraryFunction, function->isIntrinsicFunction,
-              function->useFloat, function->useDouble);
-    }
+  for (int i = 0; i < _vfc_func_table_size; i++) {
+    interflop_function_info_t *function = _vfc_func_table[i];
+    fprintf(f, "%s\t%hd\t%hd\t%hu\t%hu\n", function->id,
+            function->isLibraryFunction, function->isIntrinsicFunction,
+            function->useFloat, function->useDouble);
   }
 }
 
-void vfc_func_table_init() { _vfc_func_map = vfc_hashmap_create(); }
-
 void vfc_func_table_quit() {
-  vfc_hashmap_free(_vfc_func_map);
-
-  vfc_hashmap_destroy(_vfc_func_map);
+  // Descriptors are owned by the modules, only the table is freed
+  free(_vfc_func_table);
+  _vfc_func_table = NULL;
+  _vfc_func_table_size = 0;
+  _vfc_func_table_capacity = 0;
 }
 
 /************************************************************
  *                       Call Stack                         *
  ************************************************************/
-static interflop_function_stack_t _vfc_call_stack = {NULL,
-                                                     _VFC_CALL_STACK_MAXSIZE};
+// Each thread has its own call stack, allocated on its first instrumented
+// call. The stack grows downward: array[top] is the current function,
+// array[top + 1] its caller and the bottom slot is a NULL sentinel.
+static __thread interflop_function_stack_t _vfc_call_stack = {NULL, 0};
+static __thread long int _vfc_call_stack_size = 0;
+
+// Key whose destructor frees the call stack of a thread when it exits
+static pthread_key_t _vfc_call_stack_key;
+static pthread_once_t _vfc_call_stack_key_once = PTHREAD_ONCE_INIT;
+
+void vfc_call_stack_free();
+
+static void vfc_call_stack_destroy(__attribute__((unused)) void *stack) {
+  vfc_call_stack_free();
+}
+
+static void vfc_call_stack_key_create() {
+  if (pthread_key_create(&_vfc_call_stack_key, vfc_call_stack_destroy) != 0)
+    logger_error("Cannot create the call stack key\n");
+}
+
+// Double the size of the call stack, keeping its content at the bottom
+static void vfc_call_stack_grow() {
+  long int size = (_vfc_call_stack_size == 0)
+                      ? _VFC_CALL_STACK_INITIAL_SIZE
+                      : 2 * _vfc_call_stack_size;
+  long int used = _vfc_call_stack_size - _vfc_call_stack.top;
+
+  interflop_function_info_t **array =
+      malloc(size * sizeof(interflop_function_info_t *));
+  if (array == NULL) {
+    logger_error("Cannot grow the call stack to %ld functions\n", size);
+    return;
+  }
 
-// Initialize the call stack
+  if (_vfc_call_stack.array != NULL) {
+    memcpy(array + size - used, _vfc_call_stack.array + _vfc_call_stack.top,
+           used * sizeof(interflop_function_info_t *));
+    free(_vfc_call_stack.array);
+  }
+
+  _vfc_call_stack.array = array;
+  _vfc_call_stack.top = size - used;
+  _vfc_call_stack_size = size;
+}
+
+// Initialize the call stack of the current thread
 void vfc_call_stack_init() {
-  _vfc_call_stack.array =
-      malloc(_VFC_CALL_STACK_MAXSIZE * sizeof(interflop_function_info_t *));
+  if (_vfc_call_stack.array != NULL)
+    return;
+
+  vfc_call_stack_grow();
   _vfc_call_stack.array[--_vfc_call_stack.top] = NULL;
+
+  // The stack is freed when the thread exits
+  pthread_once(&_vfc_call_stack_key_once, vfc_call_stack_key_create);
+  pthread_setspecific(_vfc_call_stack_key, &_vfc_call_stack);
 }
 
 // Push a function in the call stack
 void vfc_call_stack_push(interflop_function_info_t *function) {
-  if (_vfc_call_stack.top == 0) {
-    logger_error("Call stack is full, it max size is %zu\n",
-                 _VFC_CALL_STACK_MAXSIZE);
-    return;
-  }
+  if (_vfc_call_stack.array == NULL)
+    vfc_call_stack_init();
+
+  if (_vfc_call_stack.top == 0)
+    vfc_call_stack_grow();
 
   _vfc_call_stack.array[--_vfc_call_stack.top] = function;
 }
 
 // Remove a function in the call stack
 interflop_function_info_t *vfc_call_stack_pop() {
-  if (_vfc_call_stack.top < _VFC_CALL_STACK_MAXSIZE)
+  if (_vfc_call_stack.top < _vfc_call_stack_size - 1)
     return _vfc_call_stack.array[_vfc_call_stack.top++];
 
   return NULL;
@@ -102,16 +160,19 @@ interflop_function_info_t *vfc_call_stack_pop() {
 
 // Print the call stack
 void vfc_call_stack_print(FILE *f) {
-  for (int i = _VFC_CALL_STACK_MAXSIZE - 2; i >= _vfc_call_stack.top; i--)
+  for (long int i = _vfc_call_stack_size - 2; i >= _vfc_call_stack.top; i--)
     fprintf(f, "%s/", _vfc_call_stack.array[i]->id);
   fprintf(f, "\n");
 }
 
-// Free the call stack
+// Free the call stack of the current thread
 void vfc_call_stack_free() {
   if (_vfc_call_stack.array) {
     free(_vfc_call_stack.array);
   }
+  _vfc_call_stack.array = NULL;
+  _vfc_call_stack.top = 0;
+  _vfc_call_stack_size = 0;
 }
 
 /************************************************************
@@ -119,52 +180,32 @@ void vfc_call_stack_free() {
  ************************************************************/
 
 // Function called before each function's call of the code
-void vfc_enter_function(char *func_name, char isLibraryFunction,
-                        char isIntrinsicFunction, size_t useFloat,
-                        size_t useDouble, int n, ...) {
-  // Get a pointer to the function if she is in the table
-  interflop_function_info_t *function = vfc_func_table_get(func_name);
-
-  if (function == NULL) {
-    interflop_function_info_t f = {func_name, isLibraryFunction,
-                                   isIntrinsicFunction, useFloat, useDouble};
-    function = vfc_func_table_add(f);
-  }
-
+// n is the number of arguments intercepted, args is an array of n arguments
+// laid out on the stack of the caller
+void vfc_enter_function(interflop_function_info_t *function, int n,
+                        interflop_function_arg_t *args) {
   vfc_call_stack_push(function);
 
-  if ((useFloat != 0) || (useDouble != 0)) {
-    va_list ap;
-    // n is the number of arguments intercepted, each argument
-    // is represented by a type ID and a pointer
-    va_start(ap, n * 4);
-
-    for (int i = 0; i < loaded_backends; i++)
-      if (backends[i].interflop_enter_function)
+  if ((function->useFloat != 0) || (function->useDouble != 0)) {
+    for (int i = 0; i < loaded_backends; i++) {
+      if (backends[i].interflop_enter_function) {
         backends[i].interflop_enter_function(&_vfc_call_stack, contexts[i], n,
-                                             ap);
-
-    va_end(ap);
+                                             args);
+      }
+    }
   }
 }
 
 // Function called after each function's call of the code
-void vfc_exit_function(__attribute__((unused)) char *func_name,
-                       __attribute__((unused)) char isLibraryFunction,
-                       __attribute__((unused)) char isIntrinsicFunction,
-                       size_t useFloat, size_t useDouble, int n, ...) {
-  if ((useFloat != 0) || (useDouble != 0)) {
-    va_list ap;
-    // n is the number of arguments intercepted, each argument
-    // is represented by a type ID and a pointer
-    va_start(ap, n * 4);
-
-    for (int i = 0; i < loaded_backends; i++)
-      if (backends[i].interflop_exit_function)
+void vfc_exit_function(interflop_function_info_t *function, int n,
+                       interflop_function_arg_t *args) {
+  if ((function->useFloat != 0) || (function->useDouble != 0)) {
+    for (int i = 0; i < loaded_backends; i++) {
+      if (backends[i].interflop_exit_function) {
         backends[i].interflop_exit_function(&_vfc_call_stack, contexts[i], n,
-                                            ap);
-
-    va_end(ap);
+                                            args);
+      }
+    }
   }
 
   vfc_call_stack_pop();
@@ -175,18 +216,16 @@ void vfc_exit_function(__attribute__((unused)) char *func_name,
  ************************************************************/
 
 void vfc_init_func_inst() {
-  // Initialize the call stack
+  // Initialize the call stack of the main thread, other threads allocate
+  // their own on their first instrumented call
   vfc_call_stack_init();
-
-  // Initialize the hashmap
-  vfc_func_table_init();
 }
 
 void vfc_quit_func_inst() {
 
-  // Free the call stack
+  // Free the call stack of the main thread
   vfc_call_stack_free();
 
-  // Free the hashmap
+  // Free the function table
   vfc_func_table_quit();
 }
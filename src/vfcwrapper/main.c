@@ -23,7 +23,9 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -463,6 +465,26 @@ void interflop_call(interflop_call_id id, ...) {
   }
 }
 
+/* Append the execution count of the operation sites of a module compiled
+ * with --inst-profile-gen to the site profile, VFC_SITE_PROFILE or
+ * vfc_site_profile.txt by default. Called by a destructor of the module. */
+void vfc_site_profile_dump(const char **sites, const uint64_t *counts, int n) {
+  const char *profile_path = getenv("VFC_SITE_PROFILE");
+  if (profile_path == NULL) {
+    profile_path = "vfc_site_profile.txt";
+  }
+
+  FILE *profile = fopen(profile_path, "a");
+  if (profile == NULL) {
+    logger_error("Cannot open site profile %s: %s", profile_path,
+                 strerror(errno));
+  }
+  for (int i = 0; i < n; i++) {
+    fprintf(profile, "%s %lu\n", sites[i], (unsigned long)counts[i]);
+  }
+  fclose(profile);
+}
+
 #define define_arithmetic_wrapper(precision, operation, operator)              \
   precision _##precision##operation(precision a, precision b) {                \
     precision c = NAN;                                                         \
@@ -506,6 +528,8 @@ int _doublecmp(enum FCMP_PREDICATE p, double a, double b) {
 }
 
 /* Arithmetic vector wrappers */
+#ifdef DDEBUG
+/* Delta-debug filters the operations one at a time */
 #define define_vectorized_arithmetic_wrapper(precision, operation, size)       \
   precision##size _##size##x##precision##operation(const precision##size a,    \
                                                    const precision##size b) {  \
@@ -516,6 +540,35 @@ int _doublecmp(enum FCMP_PREDICATE p, double a, double b) {
     }                                                                          \
     return c;                                                                  \
   }
+#else
+/* The lanes are passed at once to the backends which provide a vector hook,
+ * the other backends compute them one at a time with their scalar hook */
+#define define_vectorized_arithmetic_wrapper(precision, operation, size)       \
+  precision##size _##size##x##precision##operation(const precision##size a,    \
+                                                   const precision##size b) {  \
+    precision _a[size], _b[size], _c[size];                                    \
+    precision##size c;                                                         \
+                                                                               \
+    memcpy(_a, &a, sizeof(_a));                                                \
+    memcpy(_b, &b, sizeof(_b));                                                \
+    for (int j = 0; j < size; j++) {                                           \
+      _c[j] = NAN;                                                             \
+    }                                                                          \
+    for (unsigned char i = 0; i < loaded_backends; i++) {                      \
+      if (backends[i].interflop_##operation##_##precision##_vector) {          \
+        backends[i].interflop_##operation##_##precision##_vector(              \
+            size, _a, _b, _c, contexts[i]);                                    \
+      } else if (backends[i].interflop_##operation##_##precision) {            \
+        for (int j = 0; j < size; j++) {                                       \
+          backends[i].interflop_##operation##_##precision(                     \
+              _a[j], _b[j], &_c[j], contexts[i]);                              \
+        }                                                                      \
+      }                                                                        \
+    }                                                                          \
+    memcpy(&c, _c, sizeof(c));                                                 \
+    return c;                                                                  \
+  }
+#endif
 
 /* Define vector of size 2 */
 define_vectorized_arithmetic_wrapper(float, add, 2);
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+rm -Rf *~ *.o test test.log test2.c stats.log stats_before.log *.ll cache
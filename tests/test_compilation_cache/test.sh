@@ -0,0 +1,58 @@
+#!/bin/bash
+set -e
+
+export VFC_BACKENDS="libinterflop_ieee.so"
+export VFC_CACHE_DIR=$PWD/cache
+rm -Rf cache
+
+check_stats() {
+    verificarlo-c --cache-stats > stats.log
+    cat stats.log
+    if ! grep -q "hits: $1$" stats.log || ! grep -q "misses: $2$" stats.log; then
+        echo "Expected $1 hits and $2 misses"
+        exit 1
+    fi
+}
+
+echo "SUBTEST 1: The first compilation is a miss"
+verificarlo-c -O0 -c test.c -o test_miss.o
+check_stats 0 1
+
+echo "SUBTEST 2: The same compilation is a hit with the same object"
+verificarlo-c -O0 -c test.c -o test_hit.o
+check_stats 1 1
+cmp test_miss.o test_hit.o
+
+echo "SUBTEST 3: Changing flags or sources is a miss"
+verificarlo-c -O0 -c test.c -o test.o --inst-fcmp
+check_stats 1 2
+sed 's/3.0/4.0/' test.c > test2.c
+verificarlo-c -O0 -c test2.c -o test.o
+check_stats 1 3
+
+echo "SUBTEST 4: Cached objects link and run"
+verificarlo-c -O0 test_hit.o -o test
+./test
+
+echo "SUBTEST 5: Objects are evicted beyond the cache size"
+VFC_CACHE_SIZE=1 verificarlo-c -O0 -c test.c -o test.o -O1
+if [ $(find cache/objects -type f | wc -l) != 0 ]; then
+    echo "Objects should have been evicted"
+    exit 1
+fi
+
+echo "SUBTEST 6: --save-temps bypasses the cache and keeps the temporaries"
+verificarlo-c --cache-stats > stats_before.log
+for i in 1 2; do
+    rm -f test_temps.vfc.*.ll
+    verificarlo-c -O0 -c test.c -o test_temps.o --save-temps
+    if [ ! -f test_temps.vfc.1.ll ] || [ ! -f test_temps.vfc.2.ll ]; then
+        echo "Temporaries should be kept at compilation $i"
+        exit 1
+    fi
+done
+verificarlo-c --cache-stats > stats.log
+if ! cmp stats_before.log stats.log; then
+    echo "The cache should not be used with --save-temps"
+    exit 1
+fi
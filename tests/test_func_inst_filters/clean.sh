@@ -0,0 +1,3 @@
+#!/bin/bash
+
+rm -Rf *~ *.o test test.log test.vfcfunc.csv test.vfcinst.csv
@@ -0,0 +1,18 @@
+#include <stdio.h>
+
+double get(double *x, int i) { return x[i]; }
+
+int next(int i) { return i + 1; }
+
+double norm(double *x, int n) {
+  double s = 0;
+  for (int i = 0; i < n; i = next(i))
+    s += get(x, i) * get(x, i);
+  return s;
+}
+
+int main(void) {
+  double x[4] = {1, 2, 3, 4};
+  printf("%f %f\n", norm(x, 4), get(x, 0));
+  return 0;
+}
@@ -0,0 +1,49 @@
+#!/bin/bash
+set -e
+
+# Check the instrumented column of the call site caller -> callee
+check() {
+    grep -q "^[^,]*,$1,$2,.*,$3$" test.vfcfunc.csv || {
+        echo "call $1 -> $2 should have instrumented=$3"
+        cat test.vfcfunc.csv
+        exit 1
+    }
+}
+
+echo "SUBTEST 1: All calls are instrumented by default"
+verificarlo-c -c test.c --inst-func --inst-report=csv
+check main norm 1
+check main get 1
+check norm get 1
+check norm next 1
+
+echo "SUBTEST 2: --inst-func-min-instructions"
+verificarlo-c -c test.c --inst-func --inst-report=csv --inst-func-min-instructions 20
+check main norm 1
+check main get 0
+check norm next 0
+
+echo "SUBTEST 3: --inst-func-skip-leaf"
+verificarlo-c -c test.c --inst-func --inst-report=csv --inst-func-skip-leaf
+check main norm 1
+check main get 0
+check norm get 0
+check norm next 0
+
+echo "SUBTEST 4: --inst-func-max-depth"
+verificarlo-c -c test.c --inst-func --inst-report=csv --inst-func-max-depth 1
+check main norm 1
+check main get 1
+check norm get 0
+check norm next 0
+
+echo "SUBTEST 5: --inst-func-skip-no-fp-args"
+verificarlo-c -c test.c --inst-func --inst-report=csv --inst-func-skip-no-fp-args
+check main get 1
+check norm next 0
+
+echo "SUBTEST 6: Filtered programs run"
+verificarlo-c test.c -o test --inst-func --inst-func-skip-leaf
+VFC_BACKENDS="libinterflop_vprec.so --instrument=all" ./test
+
+echo "test passed"
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+rm -Rf *~ test test.log config.txt
@@ -0,0 +1,39 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NTHREADS 4
+#define DEPTH 10000
+
+double rec(double x, int depth) {
+  if (depth == 0)
+    return x;
+  return rec(x + 1.0, depth - 1);
+}
+
+void *work(void *arg) {
+  double *result = (double *)arg;
+  *result = rec(0.0, DEPTH);
+  return NULL;
+}
+
+int main(void) {
+  pthread_t threads[NTHREADS];
+  double results[NTHREADS];
+
+  for (int i = 0; i < NTHREADS; i++)
+    pthread_create(&threads[i], NULL, work, &results[i]);
+
+  for (int i = 0; i < NTHREADS; i++)
+    pthread_join(threads[i], NULL);
+
+  for (int i = 0; i < NTHREADS; i++) {
+    if (results[i] != DEPTH) {
+      fprintf(stderr, "thread %d computed %f instead of %d\n", i, results[i],
+              DEPTH);
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,15 @@
+#!/bin/bash
+set -e
+
+export VFC_BACKENDS_LOGGER=False
+
+verificarlo-c -O0 test.c -o test --inst-func -lpthread
+
+echo "SUBTEST 1: Deep recursions run in several threads"
+export VFC_BACKENDS="libinterflop_vprec.so --instrument=all"
+./test
+
+echo "SUBTEST 2: Calls of all the threads are recorded"
+export VFC_BACKENDS="libinterflop_vprec.so --instrument=all --prec-output-file=config.txt"
+./test
+grep -q "test.c/rec/rec" config.txt
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+rm -Rf *~ *.o *.ll test test.log verbose.log output.txt output_opt.txt
@@ -0,0 +1,26 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 1024
+
+static double scale(double x, double a) { return x * a; }
+
+void axpy(double *restrict y, const double *restrict x, double a, int n) {
+  for (int i = 0; i < n; i++) {
+    y[i] = scale(x[i], a) + y[i];
+  }
+}
+
+int main(void) {
+  double *x = malloc(N * sizeof(double));
+  double *y = malloc(N * sizeof(double));
+  for (int i = 0; i < N; i++) {
+    x[i] = i;
+    y[i] = 1.0;
+  }
+  axpy(y, x, 0.1, N);
+  printf("%.17e\n", y[N - 1]);
+  free(x);
+  free(y);
+  return 0;
+}
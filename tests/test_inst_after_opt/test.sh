@@ -0,0 +1,24 @@
+#!/bin/bash
+set -e
+
+echo "SUBTEST 1: Check that vectorized operations are instrumented"
+verificarlo-c -O0 -c test.c --inst-after-opt --verbose 2> verbose.log
+cat verbose.log
+
+# The loop must be vectorized before instrumentation
+if ! grep -q "Instrumented operations by vector width" verbose.log; then
+    echo "Missing vector width distribution"
+    exit 1
+fi
+if ! grep -E -q "^  (2|4|8): " verbose.log; then
+    echo "Loop was not vectorized before instrumentation"
+    exit 1
+fi
+
+echo "SUBTEST 2: Check that the result is unchanged with IEEE backend"
+verificarlo-c -O0 test.c --inst-after-opt -o test
+export VFC_BACKENDS="libinterflop_ieee.so"
+./test > output_opt.txt
+verificarlo-c -O0 test.c -o test
+./test > output.txt
+diff output.txt output_opt.txt
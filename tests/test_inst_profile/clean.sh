@@ -0,0 +1,3 @@
+#!/bin/bash
+
+rm -Rf *~ *.o *.ll test test.log profile.txt partial.txt check_json.py test.vfcinst.*
@@ -0,0 +1,20 @@
+#include <stdio.h>
+
+double hot(double a, double b) { return a + b; }
+
+double cold(double a, double b) { return a * b; }
+
+double never(double a, double b) { return a - b; }
+
+int main(int argc, char **argv) {
+  double x = 0.0;
+  for (int i = 0; i < 1000; i++) {
+    x = hot(x, 0.1);
+  }
+  x = cold(x, 0.5);
+  if (argc > 1) {
+    x = never(x, 1.0);
+  }
+  printf("%.17e\n", x);
+  return 0;
+}
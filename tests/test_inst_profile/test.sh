@@ -0,0 +1,47 @@
+#!/bin/bash
+set -e
+
+export VFC_BACKENDS="libinterflop_ieee.so"
+export VFC_SITE_PROFILE=profile.txt
+rm -f profile.txt
+
+echo "SUBTEST 1: Record the site profile"
+verificarlo-c -O0 test.c -o test --inst-profile-gen
+./test
+cat profile.txt
+
+if ! grep -q "test.c hot 0 1000$" profile.txt; then
+    echo "Wrong count for the hot site"
+    exit 1
+fi
+if ! grep -q "test.c cold 0 1$" profile.txt; then
+    echo "Wrong count for the cold site"
+    exit 1
+fi
+
+cat > check_json.py <<HERE
+import json, sys
+
+report = json.load(open("test.vfcinst.json"))
+functions = {f["name"]: f for f in report["functions"]}
+selected = set(sys.argv[1:])
+for name in ["hot", "cold", "never"]:
+    instrumented = len(functions[name]["instrumented"]) > 0
+    assert instrumented == (name in selected), name
+HERE
+
+echo "SUBTEST 2: Only instrument the sites covering 90% of the operations"
+verificarlo-c -O0 -c test.c --inst-profile=profile.txt \
+    --inst-profile-coverage=90 --inst-report=json
+python3 check_json.py hot
+
+echo "SUBTEST 3: Only instrument the sites executed at most 10 times"
+verificarlo-c -O0 -c test.c --inst-profile=profile.txt \
+    --inst-profile-threshold=10 --inst-report=json
+python3 check_json.py cold never
+
+echo "SUBTEST 4: Sites missing from the profile are below any threshold"
+grep -v " cold " profile.txt > partial.txt
+verificarlo-c -O0 -c test.c --inst-profile=partial.txt \
+    --inst-profile-threshold=10 --inst-report=json
+python3 check_json.py cold never
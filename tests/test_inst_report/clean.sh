@@ -0,0 +1,3 @@
+#!/bin/bash
+
+rm -Rf *~ *.o *.ll test test.log exclude.txt check_json.py test.vfcinst.* test.vfcfunc.*
@@ -0,0 +1,22 @@
+#include <stdio.h>
+
+typedef double double4 __attribute__((ext_vector_type(4)));
+
+double scalar(double a, double b) {
+  double t = a * b;
+  return t + a;
+}
+
+double4 vector(double4 a, double4 b) { return a + b; }
+
+long double extended(long double a, long double b) { return a + b; }
+
+float excluded(float a, float b) { return a - b; }
+
+int main(void) {
+  double4 a = {1, 2, 3, 4};
+  double4 v = vector(a, a);
+  printf("%f %f %Lf %f\n", scalar(1.0, 2.0), v[0], extended(1.0, 2.0),
+         excluded(1.0f, 2.0f));
+  return 0;
+}
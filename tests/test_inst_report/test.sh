@@ -0,0 +1,46 @@
+#!/bin/bash
+set -e
+
+cat > exclude.txt <<HERE
+test excluded
+HERE
+
+echo "SUBTEST 1: Check the JSON report"
+verificarlo-c -c test.c --exclude-file exclude.txt --inst-report=json
+
+cat > check_json.py <<HERE
+import json
+
+report = json.load(open("test.vfcinst.json"))
+functions = {f["name"]: f for f in report["functions"]}
+
+def instrumented(name):
+    return {(o["op"], o["type"], o["width"]): o["count"]
+            for o in functions[name]["instrumented"]}
+
+assert instrumented("scalar") == {("mul", "double", 1): 1,
+                                  ("add", "double", 1): 1}, functions["scalar"]
+assert instrumented("vector") == {("add", "double", 4): 1}, functions["vector"]
+assert functions["extended"]["skipped"][0]["reason"] == "unsupported type"
+assert functions["excluded"]["selection"] == "exclude"
+assert functions["excluded"]["rule"].endswith("test excluded")
+assert functions["excluded"]["native"] == 1
+assert functions["main"]["selection"] == "default"
+print("JSON report is correct")
+HERE
+python3 check_json.py
+
+echo "SUBTEST 2: Check the CSV report"
+verificarlo-c -c test.c --function scalar --inst-report=csv
+grep "^.*,scalar,include,--function scalar,instrumented,mul,double,1,,1$" test.vfcinst.csv
+grep "^.*,vector,exclude,--function scalar,native,,,,,1$" test.vfcinst.csv
+
+echo "SUBTEST 3: Check the function instrumentation report"
+verificarlo-c -c test.c --inst-func --inst-report=json
+python3 -c "
+import json
+sites = json.load(open('test.vfcfunc.json'))['call_sites']
+assert any(s['caller'] == 'main' and s['callee'] == 'scalar' for s in sites)
+"
+
+echo "test passed"
@@ -0,0 +1,13 @@
+#include <stdio.h>
+
+int main(void) {
+  double s = 0.0, p = 1.0, q = 1.0;
+  for (int i = 1; i <= 1000; i++) {
+    double x = 1.0 / i;
+    s = s + x;
+    p = p * (1.0 + x * x);
+    q = (q - x) / 3.0 * 3.0 + x;
+  }
+  printf("%a %a %a\n", s, p, q);
+  return 0;
+}
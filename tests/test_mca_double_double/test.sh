@@ -0,0 +1,31 @@
+#!/bin/bash
+set -e
+
+export VFC_BACKENDS_LOGGER=False
+
+verificarlo-c -O0 test.c -o test
+
+echo "SUBTEST 1: double-double and binary128 give the same samples"
+for mode in mca pb rr; do
+    for seed in 1 2 3; do
+        for prec in 53 30; do
+            options="--mode=$mode --seed=$seed --precision-binary64=$prec"
+            VFC_BACKENDS="libinterflop_mca.so $options" ./test >dd.txt
+            VFC_BACKENDS="libinterflop_mca.so $options --quad-binary64" ./test >quad.txt
+            if ! diff dd.txt quad.txt; then
+                echo "samples differ with $options"
+                exit 1
+            fi
+        done
+    done
+done
+
+echo "SUBTEST 2: Samples are perturbed"
+VFC_BACKENDS="libinterflop_mca.so --mode=ieee" ./test >ieee.txt
+VFC_BACKENDS="libinterflop_mca.so --seed=1" ./test >mca.txt
+if diff -q ieee.txt mca.txt; then
+    echo "MCA samples should differ from IEEE"
+    exit 1
+fi
+
+echo "test passed"
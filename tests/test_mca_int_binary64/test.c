@@ -0,0 +1,84 @@
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SAMPLES 5000
+
+/* xorshift64* generator, the operands are built from bits so that their
+ * generation is not instrumented */
+static uint64_t state = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t next(void) {
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * 0x2545f4914f6cdd1dULL;
+}
+
+static double from_bits(uint64_t u) {
+  double x;
+  memcpy(&x, &u, sizeof(x));
+  return x;
+}
+
+static uint64_t to_bits(double x) {
+  uint64_t u;
+  memcpy(&u, &x, sizeof(u));
+  return u;
+}
+
+/* Returns the bits of the result x, the sign and payload of NaNs depend on
+ * the implementation of the operations and are not compared */
+static uint64_t result_bits(double x) {
+  uint64_t u = to_bits(x);
+  return ((u & 0x7fffffffffffffffULL) > 0x7ff0000000000000ULL)
+             ? 0x7ff8000000000000ULL
+             : u;
+}
+
+/* Returns a double with the given biased exponent and a random sign and
+ * significand */
+static double with_exponent(uint64_t exp) {
+  uint64_t u = next();
+  return from_bits((u & 0x800fffffffffffffULL) | (exp << 52));
+}
+
+/* Returns an operand of one of the classes: normal, close to 1,
+ * subnormal, smallest normals, largest normals and special values */
+static double operand(void) {
+  static const uint64_t specials[] = {
+      0x0000000000000000ULL, 0x8000000000000000ULL, 0x7ff0000000000000ULL,
+      0xfff0000000000000ULL, 0x7ff8000000000000ULL, 0x0000000000000001ULL,
+      0x000fffffffffffffULL, 0x0010000000000000ULL, 0x7fefffffffffffffULL,
+      0x3ff0000000000000ULL};
+  switch (next() % 6) {
+  case 0:
+    return with_exponent(1 + next() % 2046);
+  case 1:
+    return with_exponent(1020 + next() % 7);
+  case 2:
+    return with_exponent(0);
+  case 3:
+    return with_exponent(1 + next() % 4);
+  case 4:
+    return with_exponent(2043 + next() % 4);
+  default:
+    return from_bits(specials[next() % 10]);
+  }
+}
+
+int main(void) {
+  for (int i = 0; i < SAMPLES; i++) {
+    double a = operand(), b = operand();
+    /* one operand out of four cancels the other in the sum or difference */
+    if (next() % 4 == 0) {
+      b = from_bits(to_bits(a) ^ (next() & 0xff) ^
+                    ((next() & 1) ? 0x8000000000000000ULL : 0));
+    }
+    printf("%016" PRIx64 " %016" PRIx64 " %016" PRIx64 " %016" PRIx64 "\n",
+           result_bits(a + b), result_bits(a - b), result_bits(a * b),
+           result_bits(a / b));
+  }
+  return 0;
+}
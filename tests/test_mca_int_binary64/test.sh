@@ -0,0 +1,43 @@
+#!/bin/bash
+set -e
+
+export VFC_BACKENDS_LOGGER=False
+
+verificarlo-c -O0 test.c -o test
+
+# Compares the integer binary64 operations of the MCA integer backend with
+# the ones computed on the __float128 type, for the options $1
+compare() {
+    VFC_BACKENDS="libinterflop_mca_int.so --simd=none $1" ./test >int.txt
+    VFC_BACKENDS="libinterflop_mca_int.so --simd=none $1 --quad-binary64" ./test >quad.txt
+    if ! cmp -s int.txt quad.txt; then
+        echo "results differ with $1"
+        diff int.txt quad.txt | head
+        exit 1
+    fi
+}
+
+echo "SUBTEST 1: integer and __float128 operations give the same samples"
+for mode in mca pb rr ieee; do
+    for seed in 1 2 3; do
+        compare "--mode=$mode --seed=$seed"
+    done
+done
+
+echo "SUBTEST 2: same samples with sparsity, DAZ and FTZ"
+for mode in mca pb rr; do
+    compare "--mode=$mode --seed=4 --sparsity=0.5"
+    compare "--mode=$mode --seed=5 --daz"
+    compare "--mode=$mode --seed=6 --ftz"
+    compare "--mode=$mode --seed=7 --daz --ftz --sparsity=0.25"
+done
+
+echo "SUBTEST 3: samples are perturbed"
+VFC_BACKENDS="libinterflop_mca_int.so --mode=ieee" ./test >ieee.txt
+VFC_BACKENDS="libinterflop_mca_int.so --seed=1" ./test >mca.txt
+if cmp -s ieee.txt mca.txt; then
+    echo "MCA samples should differ from IEEE"
+    exit 1
+fi
+
+echo "test passed"
@@ -0,0 +1,15 @@
+#include <stdio.h>
+
+double add(double a, double b) { return a + b; }
+
+double low(double a, double b) { return add(a, b); }
+
+float lowf(float a, float b) { return a + b; }
+
+int main(void) {
+  double a = 1.0, b = 1e-3;
+  float af = 1.0f, bf = 1e-3f;
+  printf("%.17g %.17g %.17g %.9g\n", low(a, b), add(a, b), a + b,
+         lowf(af, bf));
+  return 0;
+}
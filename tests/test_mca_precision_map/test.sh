@@ -0,0 +1,51 @@
+#!/bin/bash
+set -e
+
+export VFC_BACKENDS_LOGGER=False
+
+verificarlo-c -O0 test.c -o test --inst-func
+
+# Standard deviation of the column $2 of the file $1
+std() {
+    awk -v c=$2 '{ x = $c - 1.001; s += x; q += x * x; n++ }
+                 END { m = s / n; v = q / n - m * m; print sqrt(v > 0 ? v : 0) }' $1
+}
+
+cat >map.txt <<HERE
+# function or call site, precision-binary64, precision-binary32
+low 10
+lowf 53 10
+HERE
+
+echo "SUBTEST 1: mapped functions and their callees use the map precisions"
+rm -f output.txt
+for i in $(seq 1 20); do
+    VFC_BACKENDS="libinterflop_mca.so --mode=rr --precision-map=map.txt" \
+        ./test >>output.txt
+done
+# column 1: low and add called from low, 2: add, 3: main, 4: lowf
+for c in 1 4; do
+    if [[ $(std output.txt $c | awk '{ print ($1 > 1e-6) }') -ne 1 ]]; then
+        echo "column $c should be perturbed at a precision of 10"
+        exit 1
+    fi
+done
+for c in 2 3; do
+    if [[ $(std output.txt $c | awk '{ print ($1 < 1e-12) }') -ne 1 ]]; then
+        echo "column $c should keep a precision of 53"
+        exit 1
+    fi
+done
+
+echo "SUBTEST 2: invalid maps are rejected"
+echo "low 0" >bad.txt
+if VFC_BACKENDS="libinterflop_mca.so --precision-map=bad.txt" ./test; then
+    echo "a precision of 0 should be rejected"
+    exit 1
+fi
+if VFC_BACKENDS="libinterflop_mca.so --precision-map=missing.txt" ./test; then
+    echo "a missing map should be rejected"
+    exit 1
+fi
+
+echo "test passed"
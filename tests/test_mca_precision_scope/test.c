@@ -0,0 +1,50 @@
+#include <interflop.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+
+#define NTHREADS 2
+#define SAMPLES 10000
+
+static const int precisions[NTHREADS] = {10, 40};
+static double log2_std[NTHREADS];
+static pthread_barrier_t barrier;
+
+/* Sets the binary64 precision of the thread and measures the noise of its
+ * operations once all the threads have set theirs */
+void *work(void *arg) {
+  const int i = *(int *)arg;
+  volatile double a = 1.0, b = 0.1;
+  double sum = 0, sum2 = 0;
+
+  interflop_call(INTERFLOP_SET_PRECISION_BINARY64, precisions[i]);
+  pthread_barrier_wait(&barrier);
+
+  for (int k = 0; k < SAMPLES; k++) {
+    const double e = (a + b) - 1.1;
+    sum += e;
+    sum2 += e * e;
+  }
+  const double mean = sum / SAMPLES;
+  log2_std[i] = log2(sqrt(sum2 / SAMPLES - mean * mean));
+  return NULL;
+}
+
+int main(void) {
+  pthread_t threads[NTHREADS];
+  int ids[NTHREADS];
+
+  pthread_barrier_init(&barrier, NULL, NTHREADS);
+  for (int i = 0; i < NTHREADS; i++) {
+    ids[i] = i;
+    pthread_create(&threads[i], NULL, work, &ids[i]);
+  }
+  for (int i = 0; i < NTHREADS; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  for (int i = 0; i < NTHREADS; i++) {
+    printf("%d %.0f\n", precisions[i], log2_std[i]);
+  }
+  return 0;
+}
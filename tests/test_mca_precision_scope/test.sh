@@ -0,0 +1,20 @@
+#!/bin/bash
+set -e
+
+export VFC_BACKENDS_LOGGER=False
+
+verificarlo-c -O0 test.c -o test -lpthread -lm
+
+echo "SUBTEST 1: each thread keeps its own precision"
+export VFC_BACKENDS="libinterflop_mca.so"
+./test > thread.log
+cat thread.log
+# the noise of a precision t has a standard deviation close to 2^-t
+awk '{ d = $2 + $1; if (d < -3 || d > 3) exit 1 }' thread.log
+
+echo "SUBTEST 2: --precision-scope=process shares the last precision set"
+export VFC_BACKENDS="libinterflop_mca.so --precision-scope=process"
+./test > process.log
+cat process.log
+awk 'NR == 1 { s = $2 } NR == 2 { d = $2 - s; if (d < -3 || d > 3) exit 1 }' \
+    process.log
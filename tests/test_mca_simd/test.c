@@ -0,0 +1,22 @@
+#include <stdio.h>
+
+typedef double double8 __attribute__((ext_vector_type(8)));
+typedef float float8 __attribute__((ext_vector_type(8)));
+
+/* Each lane computes the same sums, the lanes of a vector are perturbed
+ * independently */
+int main(void) {
+  double8 s = 0.0, p = 1.0;
+  float8 f = 0.0f;
+  for (int i = 1; i <= 1000; i++) {
+    double8 x = 1.0 / i;
+    float8 y = 1.0f / i;
+    s = s + x;
+    p = p * (1.0 + x * x);
+    f = f + y / (y + 1.0f);
+  }
+  for (int j = 0; j < 8; j++) {
+    printf("%.17g %.17g %.9g\n", s[j], p[j], f[j]);
+  }
+  return 0;
+}
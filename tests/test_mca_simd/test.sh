@@ -0,0 +1,54 @@
+#!/bin/bash
+set -e
+
+export VFC_BACKENDS_LOGGER=False
+
+verificarlo-c -O0 test.c -o test
+
+# Standard deviation of the column $2 of the file $1
+std() {
+    awk -v c=$2 '{ x = $c; s += x; q += x * x; n++ }
+                 END { m = s / n; v = q / n - m * m; print sqrt(v > 0 ? v : 0) }' $1
+}
+
+for backend in mca mca_int; do
+    echo "${backend} SUBTEST 1: vector kernels are exact in IEEE mode"
+    VFC_BACKENDS="libinterflop_ieee.so" ./test >ref.txt
+    for simd in none auto; do
+        VFC_BACKENDS="libinterflop_${backend}.so --mode=ieee --simd=$simd" ./test >ieee.txt
+        if ! diff ref.txt ieee.txt; then
+            echo "IEEE results differ with --simd=$simd"
+            exit 1
+        fi
+    done
+
+    echo "${backend} SUBTEST 2: lanes are perturbed independently and reproducibly"
+    VFC_BACKENDS="libinterflop_${backend}.so --seed=1" ./test >seed1.txt
+    VFC_BACKENDS="libinterflop_${backend}.so --seed=1" ./test >seed1_bis.txt
+    if ! diff seed1.txt seed1_bis.txt; then
+        echo "Samples differ with the same seed"
+        exit 1
+    fi
+    if [[ $(sort -u seed1.txt | wc -l) -ne 8 ]]; then
+        echo "Lanes should give different samples"
+        exit 1
+    fi
+
+    echo "${backend} SUBTEST 3: vector and scalar kernels give the same distribution"
+    rm -f none.txt auto.txt
+    for i in $(seq 1 20); do
+        VFC_BACKENDS="libinterflop_${backend}.so --simd=none" ./test >>none.txt
+        VFC_BACKENDS="libinterflop_${backend}.so --simd=auto" ./test >>auto.txt
+    done
+    for column in 1 2 3; do
+        s_none=$(std none.txt $column)
+        s_auto=$(std auto.txt $column)
+        echo "column $column: std $s_none (scalar) $s_auto (vector)"
+        if ! awk -v a=$s_none -v b=$s_auto 'BEGIN { exit !(a > 0 && b > a / 2 && b < 2 * a) }'; then
+            echo "Standard deviations differ"
+            exit 1
+        fi
+    done
+done
+
+echo "test passed"
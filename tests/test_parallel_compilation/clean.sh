@@ -0,0 +1,3 @@
+#!/bin/bash
+
+rm -Rf *~ *.o *.ll test test.log broken.c error.log output_seq.txt output_par.txt
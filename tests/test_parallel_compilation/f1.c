@@ -0,0 +1 @@
+double f1(double x) { return x * 1.0 + 0.5; }
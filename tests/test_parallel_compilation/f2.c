@@ -0,0 +1 @@
+double f2(double x) { return x * 2.0 + 0.5; }
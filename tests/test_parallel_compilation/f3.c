@@ -0,0 +1 @@
+double f3(double x) { return x * 3.0 + 0.5; }
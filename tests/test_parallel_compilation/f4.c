@@ -0,0 +1 @@
+double f4(double x) { return x * 4.0 + 0.5; }
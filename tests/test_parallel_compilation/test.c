@@ -0,0 +1,11 @@
+#include <stdio.h>
+
+double f1(double x);
+double f2(double x);
+double f3(double x);
+double f4(double x);
+
+int main(void) {
+  printf("%.17e\n", f1(f2(f3(f4(1.0)))));
+  return 0;
+}
@@ -0,0 +1,30 @@
+#!/bin/bash
+set -e
+
+export VFC_BACKENDS="libinterflop_ieee.so"
+
+echo "SUBTEST 1: Parallel compilation gives the same program"
+verificarlo-c -O0 test.c f1.c f2.c f3.c f4.c -o test -j1
+./test > output_seq.txt
+verificarlo-c -O0 test.c f1.c f2.c f3.c f4.c -o test -j4
+./test > output_par.txt
+diff output_seq.txt output_par.txt
+
+echo "SUBTEST 2: Intermediate files are named after their source"
+verificarlo-c -O0 -c f1.c f2.c f3.c f4.c -j4 --save-temps
+for n in 1 2 3 4; do
+    if ! grep -q "f$n" f$n.vfc.2.ll; then
+        echo "Missing intermediate file f$n.vfc.2.ll"
+        exit 1
+    fi
+done
+
+echo "SUBTEST 3: Errors are reported for the failing source"
+echo "this is not C" > broken.c
+if verificarlo-c -O0 -c f1.c broken.c f2.c -j4 2> error.log; then
+    echo "Compilation of broken.c should fail"
+    exit 1
+fi
+cat error.log
+grep -q "command failed" error.log
+grep -q "broken.c" error.log
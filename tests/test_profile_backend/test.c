@@ -0,0 +1,17 @@
+#include <stdio.h>
+
+double axpy(double a, double x, double y) { return a * x + y; }
+
+double norm(double x) { return x / 1024.0; }
+
+double power(double x, int n) { return (n == 0) ? 1.0 : x * power(x, n - 1); }
+
+int main(void) {
+  double s = 0.0;
+  for (int i = 0; i < 100; i++) {
+    s = axpy(0.5, s, 1.0);
+  }
+  printf("%.17g\n", norm(s));
+  printf("%.17g %.17g\n", power(s, 3), power(norm(s), 3));
+  return 0;
+}
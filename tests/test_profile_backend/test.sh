@@ -0,0 +1,35 @@
+#!/bin/bash
+set -e
+
+export VFC_BACKENDS_LOGGER=False
+
+verificarlo-c -O0 test.c -o test --inst-func
+
+echo "SUBTEST 1: Calls and operations are counted per function"
+export VFC_BACKENDS="libinterflop_profile.so"
+./test
+awk '$NF ~ /\/main\/axpy\// && $3 == 100 && $4 == 200 { found = 1 }
+     END { exit !found }' vfc_profile.txt
+awk '$NF ~ /\/main\/norm\// && $3 == 1 && $4 == 1 { found = 1 }
+     END { exit !found }' vfc_profile.txt
+
+echo "SUBTEST 2: Calls and operations are summed per called function"
+awk '$NF == "power" && $3 == 8 && $4 == 6 { found = 1 }
+     END { exit !found }' vfc_profile.txt
+awk '$NF ~ /\/main\/power\// && $3 == 1 { n++ }
+     END { exit n != 2 }' vfc_profile.txt
+awk '$NF ~ /\/power\/power\// && $3 == 6 && $4 == 4 { found = 1 }
+     END { exit !found }' vfc_profile.txt
+
+echo "SUBTEST 3: Folded stacks go from main to the callee"
+grep -q "/main/.*;.*/main/axpy/.* [0-9]*$" vfc_profile.folded
+
+echo "SUBTEST 4: Results are those of the following backend"
+export VFC_BACKENDS="libinterflop_profile.so --output-file=tsc.txt --folded-file=tsc.folded --timer=tsc; libinterflop_ieee.so"
+./test >output.txt
+export VFC_BACKENDS="libinterflop_ieee.so"
+./test >expected.txt
+diff output.txt expected.txt
+grep -q "time unit: cycles" tsc.txt
+
+echo "test passed"
@@ -0,0 +1,36 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <interflop.h>
+
+#ifndef REAL
+#error "REAL type not defined"
+#endif
+
+#define N 1000
+
+/* Perturbs N copies of 0.1 and prints the number of perturbed values */
+/* and the number of distinct consecutive values */
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s precision\n", argv[0]);
+    return 1;
+  }
+  const int precision = atoi(argv[1]);
+  const enum FTYPES type = (sizeof(REAL) == sizeof(float)) ? FFLOAT : FDOUBLE;
+
+  REAL x[N];
+  for (int i = 0; i < N; i++) {
+    x[i] = 0.1;
+  }
+
+  interflop_call(INTERFLOP_INEXACT_ARRAY_ID, type, x, (size_t)N, precision);
+
+  int perturbed = 0, distinct = 0;
+  for (int i = 0; i < N; i++) {
+    perturbed += (x[i] != (REAL)0.1);
+    distinct += (i > 0 && x[i] != x[i - 1]);
+  }
+  printf("%d %d\n", perturbed, distinct);
+  return 0;
+}
@@ -0,0 +1,43 @@
+#!/bin/bash
+
+export VFC_BACKENDS_LOGGER=False
+
+# run_test backend real precision expected
+# expected is "none" if no value must be perturbed and "all" if most of
+# the values must be perturbed, each with a different noise
+run_test() {
+    BACKEND=$1
+    REAL=$2
+    P=$3
+    EXPECTED=$4
+    echo "Test ${BACKEND} ${REAL} ${P}"
+    read PERTURBED DISTINCT < <(VFC_BACKENDS="${BACKEND}" ./test_${REAL} ${P})
+    if [[ ${EXPECTED} == "none" && ${PERTURBED} -ne 0 ]]; then
+        echo "Test fail: ${PERTURBED} values perturbed"
+        exit 1
+    fi
+    if [[ ${EXPECTED} == "all" && (${PERTURBED} -lt 900 || ${DISTINCT} -lt 900) ]]; then
+        echo "Test fail: ${PERTURBED} values perturbed, ${DISTINCT} distinct"
+        exit 1
+    fi
+}
+
+for REAL in float double; do
+    verificarlo-c test.c -DREAL=${REAL} -o test_${REAL}
+    # IEEE backend, no noise must be introduced
+    run_test "libinterflop_ieee.so" $REAL 1 none
+    # MCA backend, the precision follows the INTERFLOP_INEXACT_ID rules
+    run_test "libinterflop_mca.so" $REAL 0 none
+    run_test "libinterflop_mca.so" $REAL 1 all
+    run_test "libinterflop_mca.so" $REAL -10 all
+    # MCA backend within IEEE mode must not introduce noise at all
+    run_test "libinterflop_mca.so -m ieee" $REAL 1 none
+    # MCA integer backend
+    run_test "libinterflop_mca_int.so" $REAL 1 all
+    run_test "libinterflop_mca_int.so -m ieee" $REAL 1 none
+    # BITMASK backend
+    run_test "libinterflop_bitmask.so --operator=rand" $REAL 1 all
+    run_test "libinterflop_bitmask.so -m ieee --operator=rand" $REAL 1 none
+done
+
+echo "test passed"
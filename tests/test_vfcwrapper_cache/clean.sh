@@ -0,0 +1,3 @@
+#!/bin/bash
+
+rm -Rf *~ *.o test test.log cmd.log cache
@@ -0,0 +1,7 @@
+#include <stdio.h>
+
+int main(void) {
+  double x = 0.1;
+  printf("%.17e\n", x + 0.2);
+  return 0;
+}
@@ -0,0 +1,40 @@
+#!/bin/bash
+set -e
+
+export VFC_BACKENDS="libinterflop_ieee.so"
+export VFC_CACHE_DIR=$PWD/cache
+rm -Rf cache
+
+echo "SUBTEST 1: The first link fills the cache"
+verificarlo-c -O0 test.c -o test
+./test
+if [ $(ls cache/vfcwrapper-*.o | wc -l) != 1 ]; then
+    echo "vfcwrapper object is not cached"
+    exit 1
+fi
+if [ -f .vfcwrapper.o ]; then
+    echo "vfcwrapper object should not be written in the current directory"
+    exit 1
+fi
+
+echo "SUBTEST 2: The next links reuse the cache"
+verificarlo-c -O0 test.c -o test --show-cmd > cmd.log
+cat cmd.log
+grep -q "using cached" cmd.log
+./test
+
+echo "SUBTEST 3: Other flags use another cache entry"
+verificarlo-c -O0 test.c -o test --inst-fcmp
+./test
+if [ $(ls cache/vfcwrapper-*.o | wc -l) != 2 ]; then
+    echo "--inst-fcmp should use a different vfcwrapper object"
+    exit 1
+fi
+
+echo "SUBTEST 4: --no-cache does not use the cache"
+verificarlo-c -O0 test.c -o test --no-cache --show-cmd > cmd.log
+if grep -q "using cached" cmd.log; then
+    echo "--no-cache should not use the cache"
+    exit 1
+fi
+./test
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+rm -Rf *~ test test.log flat.txt cct.txt input.txt output.txt
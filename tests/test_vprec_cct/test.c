@@ -0,0 +1,16 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+double dot(double a, double b) { return a * b; }
+
+double update(double a, double b) { return dot(a, b) + 0.0; }
+
+double precond(double a) { return update(a, a); }
+
+double solve(double a) { return update(a, a); }
+
+int main(int argc, char *argv[]) {
+  double a = (argc > 1) ? atof(argv[1]) : 1.1;
+  printf("%.17g %.17g\n", precond(a), solve(a));
+  return 0;
+}
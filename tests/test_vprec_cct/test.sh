@@ -0,0 +1,37 @@
+#!/bin/bash
+set -e
+
+export VFC_BACKENDS_LOGGER=False
+
+verificarlo-c -O0 test.c -o test --inst-func
+
+echo "SUBTEST 1: Records are kept per call site by default"
+export VFC_BACKENDS="libinterflop_vprec.so --prec-output-file=flat.txt"
+./test
+if [ $(grep -c "/update/dot/" flat.txt) != 1 ]; then
+    echo "dot should have a single record"
+    exit 1
+fi
+
+echo "SUBTEST 2: Records are kept per calling context with --cct-depth"
+export VFC_BACKENDS="libinterflop_vprec.so --prec-output-file=cct.txt --cct-depth=3"
+./test
+grep -q "/main/precond/.*>.*/precond/update/.*>.*/update/dot/" cct.txt
+grep -q "/main/solve/.*>.*/solve/update/.*>.*/update/dot/" cct.txt
+
+echo "SUBTEST 3: The precision of dot is only lowered when called by precond"
+awk 'BEGIN { OFS = "\t" } $1 ~ /precond\/update.*>.*update\/dot/ { $6 = 10 } { print }' cct.txt >input.txt
+export VFC_BACKENDS="libinterflop_vprec.so --prec-input-file=input.txt --cct-depth=3 --instrument=operations"
+./test 1.1 >output.txt
+cat output.txt
+read precond solve <output.txt
+if [ "$precond" == "$solve" ]; then
+    echo "precond and solve should not be computed with the same precision"
+    exit 1
+fi
+if [ "$solve" != "1.2100000000000002" ]; then
+    echo "solve should be computed in binary64"
+    exit 1
+fi
+
+echo "test passed"
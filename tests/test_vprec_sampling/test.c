@@ -0,0 +1,19 @@
+#include <stdio.h>
+
+#define N 1000
+
+double first(double *x) { return x[0] + 1.0; }
+
+int main(void) {
+  double x[N];
+  for (int i = 0; i < N; i++) {
+    x[i] = i;
+  }
+
+  double s = 0.0;
+  for (int k = 0; k < 10; k++) {
+    s += first(x);
+  }
+  printf("%.17g\n", s);
+  return 0;
+}
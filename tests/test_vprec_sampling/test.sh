@@ -0,0 +1,51 @@
+#!/bin/bash
+set -e
+
+export VFC_BACKENDS_LOGGER=False
+
+verificarlo-c -O0 test.c -o test --inst-func
+
+# Count the logged elements of the input array
+count() {
+    grep -c "input\[" log.txt
+}
+
+# Print the maximum recorded range of the input array
+max_range() {
+    awk '$1 == "input:" { print $7; exit }' config.txt
+}
+
+echo "SUBTEST 1: Every element of every call is recorded by default"
+export VFC_BACKENDS="libinterflop_vprec.so --prec-output-file=config.txt --prec-log-file=log.txt"
+./test
+[ $(count) == 10000 ]
+[ $(max_range) == 999 ]
+
+echo "SUBTEST 2: --sample-calls records one call out of N"
+export VFC_BACKENDS="libinterflop_vprec.so --prec-output-file=config.txt --prec-log-file=log.txt --sample-calls=5"
+./test
+[ $(count) == 2000 ]
+
+echo "SUBTEST 3: --max-sample-elements bounds the recorded elements"
+export VFC_BACKENDS="libinterflop_vprec.so --prec-output-file=config.txt --prec-log-file=log.txt --max-sample-elements=3"
+./test
+[ $(count) == 30 ]
+[ $(max_range) == 2 ]
+
+echo "SUBTEST 4: --sample-elements records a subset of the elements"
+export VFC_BACKENDS="libinterflop_vprec.so --prec-output-file=config.txt --prec-log-file=log.txt --sample-elements=0.1"
+./test
+n=$(count)
+if [ $n -lt 500 ] || [ $n -gt 1500 ]; then
+    echo "$n elements recorded, about 1000 expected"
+    exit 1
+fi
+
+echo "SUBTEST 5: Sampling does not change the results"
+export VFC_BACKENDS="libinterflop_vprec.so --prec-input-file=config.txt --instrument=all --mode=full --sample-calls=3 --sample-elements=0.5"
+./test >sampled.txt
+export VFC_BACKENDS="libinterflop_vprec.so --prec-input-file=config.txt --instrument=all --mode=full"
+./test >full.txt
+diff sampled.txt full.txt
+
+echo "test passed"
@@ -0,0 +1,3 @@
+#!/bin/bash
+
+rm -Rf *~ test records.txt input.txt output.txt
@@ -0,0 +1,39 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 100000
+
+double add(double a, double b) { return a + b; }
+
+/* add is called with a lowered precision by low and with the binary64
+ * precision by full, both run at the same time */
+void *low(void *arg) {
+  long *errors = (long *)arg;
+  for (int i = 0; i < N; i++)
+    if (add(1.0, 0x1p-30) != 1.0)
+      (*errors)++;
+  return NULL;
+}
+
+void *full(void *arg) {
+  long *errors = (long *)arg;
+  for (int i = 0; i < N; i++)
+    if (add(1.0, 0x1p-30) != 1.0 + 0x1p-30)
+      (*errors)++;
+  return NULL;
+}
+
+int main(void) {
+  pthread_t threads[2];
+  long errors[2] = {0, 0};
+
+  pthread_create(&threads[0], NULL, low, &errors[0]);
+  pthread_create(&threads[1], NULL, full, &errors[1]);
+
+  for (int i = 0; i < 2; i++)
+    pthread_join(threads[i], NULL);
+
+  printf("%ld %ld\n", errors[0], errors[1]);
+  return EXIT_SUCCESS;
+}
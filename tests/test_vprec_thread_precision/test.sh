@@ -0,0 +1,29 @@
+#!/bin/bash
+set -e
+
+export VFC_BACKENDS_LOGGER=False
+
+verificarlo-c -O0 test.c -o test --inst-func -lpthread
+
+echo "SUBTEST 1: Records of the call sites of add"
+export VFC_BACKENDS="libinterflop_vprec.so --prec-output-file=records.txt"
+./test
+grep -q "/low/add/" records.txt
+grep -q "/full/add/" records.txt
+
+echo "SUBTEST 2: The precision of add is only lowered in the thread running low"
+awk 'BEGIN { OFS = "\t" } $1 ~ /\/low\/add\// { $6 = 10 } { print }' records.txt >input.txt
+export VFC_BACKENDS="libinterflop_vprec.so --prec-input-file=input.txt --instrument=operations"
+./test >output.txt
+cat output.txt
+read low full <output.txt
+if [ "$low" != "0" ]; then
+    echo "add should be computed with 10 bits in low"
+    exit 1
+fi
+if [ "$full" != "0" ]; then
+    echo "add should be computed in binary64 in full"
+    exit 1
+fi
+
+echo "test passed"